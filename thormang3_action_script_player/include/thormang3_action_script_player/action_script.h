@@ -0,0 +1,125 @@
+/*******************************************************************************
+* Copyright 2018 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+/*
+ * action_script.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef THORMANG3_ACTION_SCRIPT_PLAYER_ACTION_SCRIPT_H_
+#define THORMANG3_ACTION_SCRIPT_PLAYER_ACTION_SCRIPT_H_
+
+#include <map>
+#include <string>
+#include <vector>
+#include <yaml-cpp/yaml.h>
+
+#define JOINT_NAME_KEY                    "joint_name"
+#define BRANCH_KEY                        "branch"
+#define SCRIPT_NAME_KEY                   "name"
+#define TEMPLATE_KEY                      "template"
+#define PARAMS_KEY                        "params"
+#define ACTION_PLAY_CMD_NAME              "play"
+#define MP3_PLAY_CMD_NAME                 "mp3"
+#define WAIT_ACTION_PLAY_FINISH_CMD_NAME  "wait"
+#define SLEEP_CMD_NAME                    "sleep"
+#define FORK_CMD_NAME                     "fork"
+#define JOIN_CMD_NAME                     "join"
+#define LOOP_CMD_NAME                     "loop"
+
+// loops are unrolled while parsing, so their count and the cmds of all branches of a script are limited
+#define MAX_LOOP_COUNT                    1000
+#define MAX_SCRIPT_CMD_NUM                100000
+
+namespace thormang3
+{
+
+// loops are unrolled while parsing, so the played script has no loop cmd
+enum ActionScriptCmdType
+{
+  ACTION_PLAY_CMD = 0,
+  MP3_PLAY_CMD = 1,
+  WAIT_ACTION_PLAY_FINISH_CMD = 2,
+  SLEEP_CMD = 3,
+  FORK_CMD = 4,
+  JOIN_CMD = 5
+};
+
+typedef struct
+{
+  int              cmd_type;
+  std::string      cmd_name;
+  std::string      cmd_arg_str;
+  int              cmd_arg_int;
+  std::vector<int> branch_index_list;   // only for fork, index of action_script::branch_list
+  std::string      cmd_key_path;        // keys of the cmd in the script : "cmd3/cmd1", "cmd2/branch1/cmd1"
+} action_script_cmd;
+
+typedef struct
+{
+  std::vector<std::string>       joint_name_list;
+  std::vector<action_script_cmd> cmd_list;
+} action_script_branch;
+
+typedef struct
+{
+  std::string                       name;
+  int                               number;        // -1 : script without number
+  std::vector<action_script_branch> branch_list;   // index 0 is the main sequence, the others are forked branches
+} action_script;
+
+typedef struct
+{
+  std::string key;          // top level key of the script
+  std::string name;         // "name: hello" on the first level of the script block, "" if there is not
+  std::size_t begin;        // byte range of the script block in the file
+  std::size_t end;
+  int         begin_line;   // 0-based line of the key
+} action_script_block;
+
+typedef struct
+{
+  std::string              message;
+  std::vector<std::string> key_path;   // keys from the script to the invalid item : cmd2, branch1, cmd3
+} action_script_error;
+
+typedef std::map<std::string, std::string> action_script_params;   // param name -> value
+
+std::string convertIntToString(int n);
+
+// "script<N>" -> N, otherwise -1
+int getScriptNumberFromKey(const std::string& script_key);
+
+// scans the top level keys of an action script file line by line without parsing yaml,
+// a script block lasts until the next top level key
+void scanActionScriptBlocks(const char *data, std::size_t size, std::vector<action_script_block>* block_list);
+
+// reads "params: {lang: eng, page_offset: 0}" of a script
+bool readActionScriptParams(const YAML::Node& action_script_doc, action_script_params* params);
+
+// the error is logged if error is NULL
+bool parseActionScript(const YAML::Node& action_script_doc, const std::string& script_desc, action_script* script,
+                       action_script_error* error = NULL);
+
+// ${param} in cmd_arg is replaced with instance_params or the default params of the script(template)
+bool parseActionScript(const YAML::Node& action_script_doc, const std::string& script_desc,
+                       const action_script_params& instance_params, action_script* script,
+                       action_script_error* error = NULL);
+
+}
+
+#endif /* THORMANG3_ACTION_SCRIPT_PLAYER_ACTION_SCRIPT_H_ */
@@ -0,0 +1,89 @@
+/*******************************************************************************
+* Copyright 2018 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+/*
+ * action_script_library.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef THORMANG3_ACTION_SCRIPT_PLAYER_ACTION_SCRIPT_LIBRARY_H_
+#define THORMANG3_ACTION_SCRIPT_PLAYER_ACTION_SCRIPT_LIBRARY_H_
+
+#include <map>
+#include <ctime>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include "action_script.h"
+
+namespace thormang3
+{
+
+// Index of the action scripts in many yaml files.
+// Only the top level keys of the files are scanned at startup,
+// a script is parsed from its own block of the file when it is requested first
+// and it is kept until a file is modified.
+class ActionScriptLibrary
+{
+public:
+  ActionScriptLibrary();
+  ~ActionScriptLibrary();
+
+  bool addFile(const std::string& file_path);
+  int  addDirectory(const std::string& dir_path);   // returns the number of the indexed files
+
+  // script_key : script name("hello", "script2") or number("2")
+  boost::shared_ptr<const action_script> getScript(const std::string& script_key);
+  boost::shared_ptr<const action_script> getScript(int script_number);
+
+  int getScriptCount();
+
+private:
+  typedef struct
+  {
+    std::string path;
+    std::time_t last_write_time;
+  } script_file;
+
+  typedef struct
+  {
+    int         file_index;
+    std::string key;          // top level key of the script
+    int         number;       // -1 : script without number
+    std::size_t begin;        // byte range of the script block in the file
+    std::size_t end;
+    int         begin_line;   // 0-based line of the key
+  } script_location;
+
+  int  findLocation(const std::string& script_key);
+  void addName(const std::string& name, int location_index);
+  bool indexFile(int file_index);
+  void reindexFiles();
+  bool isFileModified(int file_index);
+  bool loadScriptDoc(int location_index, YAML::Node* script_doc);
+  boost::shared_ptr<const action_script> loadScript(int location_index);   // resolves the template of an instance
+
+  boost::mutex                 mutex_;
+  std::vector<script_file>     files_;
+  std::vector<script_location> locations_;
+  std::map<std::string, int>   name_index_;     // script name -> locations_ index
+  std::map<int, int>           number_index_;   // script number -> locations_ index
+  std::map<int, boost::shared_ptr<const action_script> > script_cache_;   // locations_ index -> script
+};
+
+}
+
+#endif /* THORMANG3_ACTION_SCRIPT_PLAYER_ACTION_SCRIPT_LIBRARY_H_ */
@@ -0,0 +1,99 @@
+/*******************************************************************************
+* Copyright 2018 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+/*
+ * script_timing_profiler.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef THORMANG3_ACTION_SCRIPT_PLAYER_SCRIPT_TIMING_PROFILER_H_
+#define THORMANG3_ACTION_SCRIPT_PLAYER_SCRIPT_TIMING_PROFILER_H_
+
+#include <string>
+#include <vector>
+#include <ros/ros.h>
+#include <boost/thread/mutex.hpp>
+
+namespace thormang3
+{
+
+// Records the timeline of one action script run and exports it
+// as a chrome trace-event json(chrome://tracing) or a csv file.
+class ScriptTimingProfiler
+{
+public:
+  ScriptTimingProfiler();
+  ~ScriptTimingProfiler();
+
+  // output_dir : empty string disables the profiler, output_format : "json" or "csv"
+  void setOutput(const std::string& output_dir, const std::string& output_format);
+  bool isEnabled() const;
+
+  void startRun(const std::string& script_name);
+
+  // cmd_key_path : keys of the cmd in the script("cmd3/cmd1"), a cmd of an unrolled loop has the keys of its source.
+  // scheduled_time is the time the cmd would start if every publish and service call took no time
+  void addCommand(int branch_index, const std::string& cmd_key_path, const std::string& cmd_name,
+                  const std::string& cmd_arg_str, int cmd_arg_int,
+                  const ros::WallTime& scheduled_time, const ros::WallTime& start_time, const ros::WallTime& end_time);
+
+  // time blocked in the is_running service of the action module
+  void addServiceCall(int branch_index, const std::string& service_name,
+                      const ros::WallTime& start_time, const ros::WallTime& end_time);
+
+  // writes the recorded run to the output directory and clears it
+  bool finishRun();
+
+private:
+  enum RecordType
+  {
+    COMMAND_RECORD = 0,
+    SERVICE_CALL_RECORD = 1
+  };
+
+  typedef struct
+  {
+    int         type;
+    int         branch_index;
+    std::string cmd_key_path;
+    std::string name;
+    std::string arg_str;
+    int         arg_int;
+    int64_t     scheduled_us;
+    int64_t     start_us;
+    int64_t     end_us;
+  } timing_record;
+
+  int64_t toRunTimeUS(const ros::WallTime& time) const;
+  std::string getArgString(const timing_record& record) const;
+  std::string escapeJsonString(const std::string& str) const;
+  std::string quoteCSVString(const std::string& str) const;
+  bool writeChromeTrace(const std::string& file_path);
+  bool writeCSV(const std::string& file_path);
+
+  boost::mutex               mutex_;
+  std::string                output_dir_;
+  std::string                output_format_;
+  std::string                script_name_;
+  ros::WallTime              run_start_time_;
+  bool                       is_running_;
+  std::vector<timing_record> records_;
+};
+
+}
+
+#endif /* THORMANG3_ACTION_SCRIPT_PLAYER_SCRIPT_TIMING_PROFILER_H_ */
@@ -0,0 +1,586 @@
+/*******************************************************************************
+* Copyright 2018 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+/*
+ * action_script.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include <cstring>
+#include <sstream>
+#include <ros/ros.h>
+#include "thormang3_action_script_player/action_script.h"
+
+namespace thormang3
+{
+
+static std::string trimScriptKey(const std::string& str)
+{
+  std::size_t begin = str.find_first_not_of(" \t\r");
+  if (begin == std::string::npos)
+    return "";
+  std::size_t end = str.find_last_not_of(" \t\r");
+
+  std::string trimmed = str.substr(begin, end - begin + 1);
+
+  // remove quotes of "key" or 'key'
+  if ((trimmed.size() >= 2) && ((trimmed[0] == '"' && trimmed[trimmed.size() - 1] == '"')
+                                || (trimmed[0] == '\'' && trimmed[trimmed.size() - 1] == '\'')))
+    trimmed = trimmed.substr(1, trimmed.size() - 2);
+
+  return trimmed;
+}
+
+std::string convertIntToString(int n)
+{
+  std::ostringstream ostr;
+  ostr << n;
+  return ostr.str();
+}
+
+int getScriptNumberFromKey(const std::string& script_key)
+{
+  const std::string prefix = "script";
+  if ((script_key.size() <= prefix.size()) || (script_key.compare(0, prefix.size(), prefix) != 0))
+    return -1;
+
+  int number = 0;
+  for (unsigned int char_idx = prefix.size(); char_idx < script_key.size(); char_idx++)
+  {
+    if (script_key[char_idx] < '0' || script_key[char_idx] > '9')
+      return -1;
+    number = number * 10 + (script_key[char_idx] - '0');
+  }
+
+  return number;
+}
+
+void scanActionScriptBlocks(const char *data, std::size_t size, std::vector<action_script_block>* block_list)
+{
+  block_list->clear();
+
+  int child_indent = -1;
+  int line_num = 0;
+  for (std::size_t line_begin = 0; line_begin < size; line_num++)
+  {
+    const char *line_end_ptr = static_cast<const char*>(memchr(data + line_begin, '\n', size - line_begin));
+    std::size_t line_end = (line_end_ptr == 0) ? size : (line_end_ptr - data);
+    std::string line(data + line_begin, line_end - line_begin);
+
+    std::size_t indent = line.find_first_not_of(" \t");
+    bool is_empty = (indent == std::string::npos) || (line[indent] == '#') || (line[indent] == '\r');
+
+    if ((is_empty == false) && (indent == 0) && (line[0] != '-') && (line.compare(0, 3, "...") != 0))
+    {
+      std::size_t colon = line.find(':');
+      if (colon != std::string::npos)
+      {
+        if (block_list->size() != 0)
+          block_list->back().end = line_begin;
+
+        action_script_block block;
+        block.key        = trimScriptKey(line.substr(0, colon));
+        block.name       = "";
+        block.begin      = line_begin;
+        block.end        = size;
+        block.begin_line = line_num;
+
+        child_indent = -1;
+        block_list->push_back(block);
+      }
+    }
+    else if ((is_empty == false) && (block_list->size() != 0))
+    {
+      // "name: hello" on the first level of the script block gives the script another name
+      if (child_indent < 0)
+        child_indent = indent;
+
+      if ((int) indent == child_indent && line.compare(indent, strlen(SCRIPT_NAME_KEY) + 1, SCRIPT_NAME_KEY ":") == 0)
+      {
+        std::string name = line.substr(indent + strlen(SCRIPT_NAME_KEY) + 1);
+        std::size_t comment = name.find(" #");
+        if (comment != std::string::npos)
+          name = name.substr(0, comment);
+
+        block_list->back().name = trimScriptKey(name);
+      }
+    }
+
+    line_begin = line_end + 1;
+  }
+}
+
+static void setParseError(const std::string& status_msg, const std::vector<std::string>& branch_key_path,
+                          const std::string& key, action_script_error* error)
+{
+  if (error == NULL)
+  {
+    ROS_ERROR_STREAM(status_msg);
+    return;
+  }
+
+  error->message  = status_msg;
+  error->key_path = branch_key_path;
+  error->key_path.push_back(key);
+}
+
+// replaces ${param_name} with the value of the param
+static bool substituteParams(const std::string& arg, const action_script_params& params, std::string* result,
+                             std::string* unknown_param)
+{
+  if (arg.find("${") == std::string::npos)
+  {
+    *result = arg;
+    return true;
+  }
+
+  result->clear();
+  std::size_t copy_begin = 0;
+  while (true)
+  {
+    std::size_t param_begin = arg.find("${", copy_begin);
+    std::size_t param_end = (param_begin == std::string::npos) ? std::string::npos : arg.find('}', param_begin);
+    if (param_end == std::string::npos)
+      break;
+
+    std::string param_name = arg.substr(param_begin + 2, param_end - param_begin - 2);
+    action_script_params::const_iterator param_it = params.find(param_name);
+    if (param_it == params.end())
+    {
+      *unknown_param = param_name;
+      return false;
+    }
+
+    result->append(arg, copy_begin, param_begin - copy_begin);
+    result->append(param_it->second);
+    copy_begin = param_end + 1;
+  }
+
+  result->append(arg, copy_begin, std::string::npos);
+  return true;
+}
+
+// "12", "10+2", "${page_offset}+2" after substitution
+static bool evaluateIntArg(const std::string& arg, int* value)
+{
+  std::istringstream arg_stream(arg);
+  int sum = 0;
+  int term = 0;
+  if (!(arg_stream >> term))
+    return false;
+  sum = term;
+
+  char op;
+  while (arg_stream >> op)
+  {
+    if (((op != '+') && (op != '-')) || !(arg_stream >> term))
+      return false;
+    sum += (op == '+') ? term : -term;
+  }
+
+  *value = sum;
+  return true;
+}
+
+static std::size_t countActionScriptCmds(const action_script& script)
+{
+  std::size_t cmd_num = 0;
+  for (unsigned int branch_idx = 0; branch_idx < script.branch_list.size(); branch_idx++)
+    cmd_num += script.branch_list[branch_idx].cmd_list.size();
+
+  return cmd_num;
+}
+
+static bool parseActionScriptSequence(const YAML::Node& sequence_doc, const std::string& sequence_desc,
+                                      const std::vector<std::string>& sequence_key_path,
+                                      const std::vector<std::string>& joint_name_list, int branch_index,
+                                      const action_script_params& params, action_script* script,
+                                      action_script_error* error);
+
+static bool parseActionScriptBranch(const YAML::Node& branch_doc, const std::string& branch_desc,
+                                    const std::vector<std::string>& branch_key_path,
+                                    const std::vector<std::string>& parent_joint_name_list, int branch_index,
+                                    const action_script_params& params, action_script* script,
+                                    action_script_error* error)
+{
+  // a branch without its own joint_name plays on the joints of its parent
+  std::vector<std::string> joint_name_list = parent_joint_name_list;
+  try
+  {
+    YAML::Node joint_name_doc = branch_doc[JOINT_NAME_KEY];
+    if (joint_name_doc != NULL)
+      joint_name_list = joint_name_doc.as< std::vector<std::string> >();
+  } catch (const std::exception& e)
+  {
+    std::string status_msg = std::string(JOINT_NAME_KEY) + " of " + branch_desc + " is invalid.";
+    setParseError(status_msg, branch_key_path, JOINT_NAME_KEY, error);
+    return false;
+  }
+  script->branch_list[branch_index].joint_name_list = joint_name_list;
+
+  return parseActionScriptSequence(branch_doc, branch_desc, branch_key_path, joint_name_list, branch_index, params,
+                                   script, error);
+}
+
+// parses cmd1, cmd2, ... of a branch or a loop and appends them to the branch
+static bool parseActionScriptSequence(const YAML::Node& sequence_doc, const std::string& sequence_desc,
+                                      const std::vector<std::string>& sequence_key_path,
+                                      const std::vector<std::string>& joint_name_list, int branch_index,
+                                      const action_script_params& params, action_script* script,
+                                      action_script_error* error)
+{
+  int cmd_num = 1;
+  std::string cmd_key = "";
+  try
+  {
+    while (true)
+    {
+      //check cmd exist
+      cmd_key = "cmd" + convertIntToString(cmd_num);
+      YAML::Node action_script_cmd_doc = sequence_doc[cmd_key];
+      if (action_script_cmd_doc == NULL)
+      {
+        break;
+      }
+
+      std::string cmd_desc = "cmd#" + convertIntToString(cmd_num) + " of " + sequence_desc;
+      std::vector<std::string> cmd_key_path = sequence_key_path;
+      cmd_key_path.push_back(cmd_key);
+
+      //check validity of cmd_name
+      action_script_cmd temp_cmd;
+      temp_cmd.cmd_arg_int = 0;
+      for (unsigned int key_idx = 0; key_idx < cmd_key_path.size(); key_idx++)
+        temp_cmd.cmd_key_path += ((key_idx == 0) ? "" : "/") + cmd_key_path[key_idx];
+
+      if (action_script_cmd_doc["cmd_name"] == NULL)
+      {
+        setParseError(cmd_desc + " is invalid : no cmd_name.", sequence_key_path, cmd_key, error);
+        return false;
+      }
+
+      //check  validity of cmd_arg
+      temp_cmd.cmd_name = action_script_cmd_doc["cmd_name"].as<std::string>();
+      if ((temp_cmd.cmd_name != WAIT_ACTION_PLAY_FINISH_CMD_NAME) && (temp_cmd.cmd_name != FORK_CMD_NAME)
+          && (temp_cmd.cmd_name != JOIN_CMD_NAME) && (action_script_cmd_doc["cmd_arg"] == NULL))
+      {
+        setParseError(cmd_desc + " is invalid : no cmd_arg.", sequence_key_path, cmd_key, error);
+        return false;
+      }
+
+      //substitute params of the template, the played script has only the resolved arguments
+      std::string cmd_arg = "";
+      if (action_script_cmd_doc["cmd_arg"] != NULL)
+      {
+        std::string unknown_param = "";
+        if (substituteParams(action_script_cmd_doc["cmd_arg"].as<std::string>(), params, &cmd_arg,
+                             &unknown_param) == false)
+        {
+          setParseError(cmd_desc + " is invalid : unknown param [" + unknown_param + "].", sequence_key_path,
+                        cmd_key, error);
+          return false;
+        }
+      }
+
+      //get cmd_arg
+      if ((temp_cmd.cmd_name == ACTION_PLAY_CMD_NAME) || (temp_cmd.cmd_name == SLEEP_CMD_NAME)
+          || (temp_cmd.cmd_name == LOOP_CMD_NAME))
+      {
+        if (evaluateIntArg(cmd_arg, &temp_cmd.cmd_arg_int) == false)
+        {
+          setParseError(cmd_desc + " is invalid : cmd_arg [" + cmd_arg + "] is not a number.", sequence_key_path,
+                        cmd_key, error);
+          return false;
+        }
+      }
+
+      if (temp_cmd.cmd_name == ACTION_PLAY_CMD_NAME)
+      {
+        temp_cmd.cmd_type = ACTION_PLAY_CMD;
+      }
+      else if (temp_cmd.cmd_name == MP3_PLAY_CMD_NAME)
+      {
+        temp_cmd.cmd_type = MP3_PLAY_CMD;
+        temp_cmd.cmd_arg_str = cmd_arg;
+      }
+      else if (temp_cmd.cmd_name == WAIT_ACTION_PLAY_FINISH_CMD_NAME)
+      {
+        temp_cmd.cmd_type = WAIT_ACTION_PLAY_FINISH_CMD;
+      }
+      else if (temp_cmd.cmd_name == JOIN_CMD_NAME)
+      {
+        temp_cmd.cmd_type = JOIN_CMD;
+      }
+      else if (temp_cmd.cmd_name == SLEEP_CMD_NAME)
+      {
+        temp_cmd.cmd_type = SLEEP_CMD;
+        if (temp_cmd.cmd_arg_int < 0)
+        {
+          setParseError(cmd_desc + " is invalid : negative sleep time.", sequence_key_path, cmd_key, error);
+          return false;
+        }
+      }
+      else if (temp_cmd.cmd_name == LOOP_CMD_NAME)
+      {
+        //unroll the loop, its cmds are appended to the branch cmd_arg times
+        if (temp_cmd.cmd_arg_int < 0)
+        {
+          setParseError(cmd_desc + " is invalid : negative loop count.", sequence_key_path, cmd_key, error);
+          return false;
+        }
+
+        if (temp_cmd.cmd_arg_int > MAX_LOOP_COUNT)
+        {
+          setParseError(cmd_desc + " is invalid : loop count is over " + convertIntToString(MAX_LOOP_COUNT) + ".",
+                        sequence_key_path, cmd_key, error);
+          return false;
+        }
+
+        if (action_script_cmd_doc["cmd1"] == NULL)
+        {
+          setParseError(cmd_desc + " is invalid : loop has no cmd.", sequence_key_path, cmd_key, error);
+          return false;
+        }
+
+        for (int loop_idx = 0; loop_idx < temp_cmd.cmd_arg_int; loop_idx++)
+        {
+          if (parseActionScriptSequence(action_script_cmd_doc, cmd_desc, cmd_key_path, joint_name_list,
+                                        branch_index, params, script, error) == false)
+            return false;
+
+          // a fork in the loop adds new branches at each iteration
+          if (countActionScriptCmds(*script) > MAX_SCRIPT_CMD_NUM)
+          {
+            setParseError(cmd_desc + " is invalid : the unrolled loop makes more than "
+                              + convertIntToString(MAX_SCRIPT_CMD_NUM) + " cmds in the script.",
+                          sequence_key_path, cmd_key, error);
+            return false;
+          }
+        }
+
+        cmd_num++;
+        continue;
+      }
+      else if (temp_cmd.cmd_name == FORK_CMD_NAME)
+      {
+        temp_cmd.cmd_type = FORK_CMD;
+
+        //get branches : branch1, branch2, ...
+        int branch_num = 1;
+        while (true)
+        {
+          std::string sub_branch_key = BRANCH_KEY + convertIntToString(branch_num);
+          YAML::Node sub_branch_doc = action_script_cmd_doc[sub_branch_key];
+          if (sub_branch_doc == NULL)
+            break;
+
+          int sub_branch_index = script->branch_list.size();
+          script->branch_list.push_back(action_script_branch());
+
+          std::string sub_branch_desc = "branch#" + convertIntToString(branch_num) + " of " + cmd_desc;
+          std::vector<std::string> sub_branch_key_path = cmd_key_path;
+          sub_branch_key_path.push_back(sub_branch_key);
+          if (parseActionScriptBranch(sub_branch_doc, sub_branch_desc, sub_branch_key_path, joint_name_list,
+                                      sub_branch_index, params, script, error) == false)
+            return false;
+
+          temp_cmd.branch_index_list.push_back(sub_branch_index);
+          branch_num++;
+        }
+
+        if (temp_cmd.branch_index_list.size() == 0)
+        {
+          setParseError(cmd_desc + " has no branch.", sequence_key_path, cmd_key, error);
+          return false;
+        }
+      }
+      else
+      {
+        setParseError(cmd_desc + " is invalid : unknown cmd_name [" + temp_cmd.cmd_name + "].", sequence_key_path,
+                      cmd_key, error);
+        return false;
+      }
+
+      // branch_list can be reallocated while parsing a fork
+      script->branch_list[branch_index].cmd_list.push_back(temp_cmd);
+      cmd_num++;
+    }
+  } catch (const std::exception& e)
+  {
+    std::string status_msg = "cmd#" + convertIntToString(cmd_num) + " of " + sequence_desc + " is invalid.";
+    setParseError(status_msg, sequence_key_path, cmd_key, error);
+    return false;
+  }
+
+  return true;
+}
+
+bool readActionScriptParams(const YAML::Node& action_script_doc, action_script_params* params)
+{
+  YAML::Node params_doc = action_script_doc[PARAMS_KEY];
+  if (params_doc == NULL)
+    return true;
+
+  try
+  {
+    for (YAML::const_iterator param_it = params_doc.begin(); param_it != params_doc.end(); ++param_it)
+      (*params)[param_it->first.as<std::string>()] = param_it->second.as<std::string>();
+  } catch (const std::exception& e)
+  {
+    return false;
+  }
+
+  return true;
+}
+
+static bool hasActionPlayCmd(const action_script& script, int branch_index)
+{
+  const action_script_branch& branch = script.branch_list[branch_index];
+  for (unsigned int cmd_idx = 0; cmd_idx < branch.cmd_list.size(); cmd_idx++)
+  {
+    const action_script_cmd& cmd = branch.cmd_list[cmd_idx];
+    if (cmd.cmd_type == ACTION_PLAY_CMD)
+      return true;
+
+    for (unsigned int fork_idx = 0; fork_idx < cmd.branch_index_list.size(); fork_idx++)
+    {
+      if (hasActionPlayCmd(script, cmd.branch_index_list[fork_idx]) == true)
+        return true;
+    }
+  }
+
+  return false;
+}
+
+// the action module plays one page at a time and "wait" checks the action status of the whole robot,
+// so only one of the sequences running at the same time(forked branches and the forking sequence until "join")
+// can play pages. a page played without "wait" before a fork is still running in the forking sequence
+static bool checkConcurrentActionPlay(const action_script& script, int branch_index, const std::string& script_desc,
+                                      action_script_error* error)
+{
+  const action_script_branch& branch = script.branch_list[branch_index];
+  const action_script_cmd* first_fork_cmd = NULL;   // the first fork after the last join
+  int playing_sequence_num = 0;
+  bool is_forking_sequence_playing = false;
+  bool is_page_playing = false;                      // a page is played and not waited
+
+  for (unsigned int cmd_idx = 0; cmd_idx < branch.cmd_list.size(); cmd_idx++)
+  {
+    const action_script_cmd& cmd = branch.cmd_list[cmd_idx];
+    switch (cmd.cmd_type)
+    {
+      case ACTION_PLAY_CMD:
+        is_page_playing = true;
+        if (first_fork_cmd != NULL)
+          is_forking_sequence_playing = true;
+        break;
+
+      case WAIT_ACTION_PLAY_FINISH_CMD:
+        is_page_playing = false;
+        break;
+
+      case FORK_CMD:
+        if (first_fork_cmd == NULL)
+          first_fork_cmd = &cmd;
+        if (is_page_playing == true)
+          is_forking_sequence_playing = true;
+
+        for (unsigned int fork_idx = 0; fork_idx < cmd.branch_index_list.size(); fork_idx++)
+        {
+          int sub_branch_index = cmd.branch_index_list[fork_idx];
+          if (checkConcurrentActionPlay(script, sub_branch_index, script_desc, error) == false)
+            return false;
+
+          if (hasActionPlayCmd(script, sub_branch_index) == true)
+            playing_sequence_num++;
+        }
+        break;
+
+      case JOIN_CMD:
+        first_fork_cmd = NULL;
+        playing_sequence_num = 0;
+        is_forking_sequence_playing = false;
+        break;
+
+      default:
+        break;
+    }
+
+    if (playing_sequence_num + (is_forking_sequence_playing ? 1 : 0) > 1)
+    {
+      std::vector<std::string> fork_key_path;
+      std::string key;
+      std::istringstream key_path_stream(first_fork_cmd->cmd_key_path);
+      while (std::getline(key_path_stream, key, '/'))
+        fork_key_path.push_back(key);
+      key = fork_key_path.back();
+      fork_key_path.pop_back();
+
+      setParseError(script_desc + " is invalid : play cmds run at the same time in the branches of the fork ["
+                        + first_fork_cmd->cmd_key_path + "], the action module plays one page at a time.",
+                    fork_key_path, key, error);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool parseActionScript(const YAML::Node& action_script_doc, const std::string& script_desc, action_script* script,
+                       action_script_error* error)
+{
+  return parseActionScript(action_script_doc, script_desc, action_script_params(), script, error);
+}
+
+bool parseActionScript(const YAML::Node& action_script_doc, const std::string& script_desc,
+                       const action_script_params& instance_params, action_script* script,
+                       action_script_error* error)
+{
+  script->branch_list.clear();
+  script->branch_list.push_back(action_script_branch());
+
+  // default values of the template, overridden by the instance
+  action_script_params params;
+  if (readActionScriptParams(action_script_doc, &params) == false)
+  {
+    setParseError(std::string(PARAMS_KEY) + " of " + script_desc + " is invalid.", std::vector<std::string>(),
+                  PARAMS_KEY, error);
+    script->branch_list.clear();
+    return false;
+  }
+
+  for (action_script_params::const_iterator param_it = instance_params.begin(); param_it != instance_params.end();
+       ++param_it)
+    params[param_it->first] = param_it->second;
+
+  if (parseActionScriptBranch(action_script_doc, script_desc, std::vector<std::string>(), std::vector<std::string>(),
+                              0, params, script, error) == false)
+  {
+    script->branch_list.clear();
+    return false;
+  }
+
+  if (checkConcurrentActionPlay(*script, 0, script_desc, error) == false)
+  {
+    script->branch_list.clear();
+    return false;
+  }
+
+  return true;
+}
+
+}
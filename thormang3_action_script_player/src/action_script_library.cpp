@@ -0,0 +1,335 @@
+/*******************************************************************************
+* Copyright 2018 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+/*
+ * action_script_library.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include <algorithm>
+#include <ros/ros.h>
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include "thormang3_action_script_player/action_script_library.h"
+
+using namespace thormang3;
+
+ActionScriptLibrary::ActionScriptLibrary()
+{
+}
+
+ActionScriptLibrary::~ActionScriptLibrary()
+{
+}
+
+bool ActionScriptLibrary::addFile(const std::string& file_path)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+
+  script_file new_file;
+  new_file.path            = file_path;
+  new_file.last_write_time = 0;
+
+  files_.push_back(new_file);
+  if (indexFile(files_.size() - 1) == false)
+  {
+    files_.pop_back();
+    ROS_ERROR_STREAM("Failed to index action script file : " << file_path);
+    return false;
+  }
+
+  return true;
+}
+
+int ActionScriptLibrary::addDirectory(const std::string& dir_path)
+{
+  std::vector<std::string> file_list;
+  try
+  {
+    boost::filesystem::directory_iterator end_it;
+    for (boost::filesystem::directory_iterator dir_it(dir_path); dir_it != end_it; ++dir_it)
+    {
+      if (boost::filesystem::is_regular_file(dir_it->status()) == false)
+        continue;
+
+      std::string extension = dir_it->path().extension().string();
+      if ((extension == ".yaml") || (extension == ".yml"))
+        file_list.push_back(dir_it->path().string());
+    }
+  } catch (const boost::filesystem::filesystem_error& e)
+  {
+    ROS_ERROR_STREAM("Failed to read action script directory : " << dir_path);
+    return 0;
+  }
+
+  // the first file in name order wins for a duplicated script name
+  std::sort(file_list.begin(), file_list.end());
+
+  int file_count = 0;
+  for (unsigned int file_idx = 0; file_idx < file_list.size(); file_idx++)
+  {
+    if (addFile(file_list[file_idx]) == true)
+      file_count++;
+  }
+
+  return file_count;
+}
+
+boost::shared_ptr<const action_script> ActionScriptLibrary::getScript(int script_number)
+{
+  return getScript(convertIntToString(script_number));
+}
+
+boost::shared_ptr<const action_script> ActionScriptLibrary::getScript(const std::string& script_key)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+
+  // a file was edited after indexing, all files are indexed again in their order :
+  // a name dropped as a duplicate can be found in another file after the edit,
+  // and a script can be an instance of a template in another file
+  bool is_modified = false;
+  for (unsigned int file_idx = 0; file_idx < files_.size(); file_idx++)
+  {
+    if (isFileModified(file_idx) == false)
+      continue;
+
+    ROS_INFO_STREAM("Action script file is modified : " << files_[file_idx].path);
+    is_modified = true;
+  }
+
+  if (is_modified == true)
+    reindexFiles();
+
+  int location_index = findLocation(script_key);
+  if (location_index < 0)
+  {
+    ROS_ERROR_STREAM("Failed to find action script : " << script_key);
+    return boost::shared_ptr<const action_script>();
+  }
+
+  std::map<int, boost::shared_ptr<const action_script> >::iterator cache_it = script_cache_.find(location_index);
+  if (cache_it != script_cache_.end())
+    return cache_it->second;
+
+  boost::shared_ptr<const action_script> script = loadScript(location_index);
+  if (script)
+    script_cache_[location_index] = script;
+
+  return script;
+}
+
+int ActionScriptLibrary::getScriptCount()
+{
+  boost::mutex::scoped_lock lock(mutex_);
+
+  return locations_.size();
+}
+
+int ActionScriptLibrary::findLocation(const std::string& script_key)
+{
+  std::map<std::string, int>::iterator name_it = name_index_.find(script_key);
+  if (name_it != name_index_.end())
+    return name_it->second;
+
+  // number
+  if ((script_key.size() == 0) || (script_key.find_first_not_of("0123456789") != std::string::npos))
+    return -1;
+
+  std::map<int, int>::iterator number_it = number_index_.find(atoi(script_key.c_str()));
+  if (number_it != number_index_.end())
+    return number_it->second;
+
+  return -1;
+}
+
+void ActionScriptLibrary::addName(const std::string& name, int location_index)
+{
+  if (name_index_.insert(std::make_pair(name, location_index)).second == false)
+  {
+    const script_location& location = locations_[location_index];
+    ROS_WARN_STREAM("Action script name [" << name << "] in " << files_[location.file_index].path << ":"
+                    << location.begin_line + 1 << " is duplicated, it is ignored.");
+  }
+}
+
+bool ActionScriptLibrary::indexFile(int file_index)
+{
+  script_file& file = files_[file_index];
+
+  try
+  {
+    file.last_write_time = boost::filesystem::last_write_time(file.path);
+
+    // mapping an empty file fails
+    if (boost::filesystem::file_size(file.path) == 0)
+      return true;
+  } catch (const boost::filesystem::filesystem_error& e)
+  {
+    return false;
+  }
+
+  boost::iostreams::mapped_file_source mapped_file;
+  try
+  {
+    mapped_file.open(file.path);
+  } catch (const std::exception& e)
+  {
+    return false;
+  }
+
+  std::vector<action_script_block> block_list;
+  scanActionScriptBlocks(mapped_file.data(), mapped_file.size(), &block_list);
+
+  for (unsigned int block_idx = 0; block_idx < block_list.size(); block_idx++)
+  {
+    const action_script_block& block = block_list[block_idx];
+
+    script_location location;
+    location.file_index = file_index;
+    location.key        = block.key;
+    location.number     = getScriptNumberFromKey(block.key);
+    location.begin      = block.begin;
+    location.end        = block.end;
+    location.begin_line = block.begin_line;
+
+    int location_index = locations_.size();
+    locations_.push_back(location);
+
+    addName(location.key, location_index);
+    if (block.name != "")
+      addName(block.name, location_index);
+
+    if (location.number >= 0)
+    {
+      if (number_index_.insert(std::make_pair(location.number, location_index)).second == false)
+        ROS_WARN_STREAM("Action script #" << location.number << " in " << file.path << ":"
+                        << location.begin_line + 1 << " is duplicated, it is ignored.");
+    }
+  }
+
+  return true;
+}
+
+void ActionScriptLibrary::reindexFiles()
+{
+  locations_.clear();
+  name_index_.clear();
+  number_index_.clear();
+  script_cache_.clear();
+
+  for (unsigned int file_idx = 0; file_idx < files_.size(); file_idx++)
+  {
+    if (indexFile(file_idx) == false)
+      ROS_ERROR_STREAM("Failed to index action script file : " << files_[file_idx].path);
+  }
+}
+
+bool ActionScriptLibrary::isFileModified(int file_index)
+{
+  try
+  {
+    return (boost::filesystem::last_write_time(files_[file_index].path) != files_[file_index].last_write_time);
+  } catch (const boost::filesystem::filesystem_error& e)
+  {
+    return false;
+  }
+}
+
+bool ActionScriptLibrary::loadScriptDoc(int location_index, YAML::Node* script_doc)
+{
+  const script_location& location = locations_[location_index];
+  const script_file& file = files_[location.file_index];
+
+  try
+  {
+    boost::iostreams::mapped_file_source mapped_file(file.path);
+    if (location.end > mapped_file.size())
+      return false;
+
+    // parse only the block of the script
+    YAML::Node script_block_doc = YAML::Load(std::string(mapped_file.data() + location.begin,
+                                                         location.end - location.begin));
+    *script_doc = script_block_doc[location.key];
+  } catch (const std::exception& e)
+  {
+    return false;
+  }
+
+  return (*script_doc != NULL);
+}
+
+boost::shared_ptr<const action_script> ActionScriptLibrary::loadScript(int location_index)
+{
+  const script_location& location = locations_[location_index];
+  std::string script_desc = location.key + " of " + files_[location.file_index].path;
+
+  YAML::Node script_doc;
+  if (loadScriptDoc(location_index, &script_doc) == false)
+  {
+    ROS_ERROR_STREAM("Failed to load " << script_desc);
+    return boost::shared_ptr<const action_script>();
+  }
+
+  boost::shared_ptr<action_script> script(new action_script);
+  script->name   = location.key;
+  script->number = location.number;
+
+  // "template: greet" makes an instance of the script greet with its own params
+  if (script_doc[TEMPLATE_KEY] != NULL)
+  {
+    action_script_params instance_params;
+    std::string template_key = "";
+    try
+    {
+      template_key = script_doc[TEMPLATE_KEY].as<std::string>();
+    } catch (const std::exception& e)
+    {
+    }
+
+    if (readActionScriptParams(script_doc, &instance_params) == false)
+    {
+      ROS_ERROR_STREAM(PARAMS_KEY << " of " << script_desc << " is invalid.");
+      return boost::shared_ptr<const action_script>();
+    }
+
+    YAML::Node template_doc;
+    int template_location = findLocation(template_key);
+    if ((template_location < 0) || (loadScriptDoc(template_location, &template_doc) == false))
+    {
+      ROS_ERROR_STREAM("Failed to load template [" << template_key << "] of " << script_desc);
+      return boost::shared_ptr<const action_script>();
+    }
+
+    if (template_doc[TEMPLATE_KEY] != NULL)
+    {
+      ROS_ERROR_STREAM("Template [" << template_key << "] of " << script_desc
+                       << " is an instance of another template.");
+      return boost::shared_ptr<const action_script>();
+    }
+
+    std::string instance_desc = template_key + " for " + script_desc;
+    if (parseActionScript(template_doc, instance_desc, instance_params, script.get()) == false)
+      return boost::shared_ptr<const action_script>();
+
+    return script;
+  }
+
+  if (parseActionScript(script_doc, script_desc, script.get()) == false)
+    return boost::shared_ptr<const action_script>();
+
+  return script;
+}
@@ -30,57 +30,56 @@
 #include "robotis_controller_msgs/StatusMsg.h"
 #include "thormang3_action_module_msgs/IsRunning.h"
 #include "thormang3_action_module_msgs/StartAction.h"
+#include "thormang3_action_script_player/action_script_library.h"
+#include "thormang3_action_script_player/script_timing_profiler.h"
 
-#define JOINT_NAME_KEY                    "joint_name"
-#define ACTION_PLAY_CMD_NAME              "play"
-#define MP3_PLAY_CMD_NAME                 "mp3"
-#define WAIT_ACTION_PLAY_FINISH_CMD_NAME  "wait"
-#define SLEEP_CMD_NAME                    "sleep"
+using thormang3::action_script;
+using thormang3::action_script_branch;
+using thormang3::action_script_cmd;
+using thormang3::convertIntToString;
 
 ros::Subscriber    g_action_script_num_sub;
+ros::Subscriber    g_action_script_name_sub;
 ros::Publisher     g_action_page_num_pub;
 ros::Publisher     g_start_action_pub;
 ros::Publisher     g_sound_file_name_pub;
 ros::ServiceClient g_is_running_client;
 
-thormang3_action_module_msgs::IsRunning  g_is_running_srv;
+boost::mutex       g_is_running_mutex;
 
 boost::thread     *g_action_script_play_thread;
 
 std::string        g_action_script_file_path;
+std::string        g_action_script_dir_path;
 
-typedef struct
-{
-  std::string cmd_name;
-  std::string cmd_arg_str;
-  int         cmd_arg_int;
-} action_script_cmd;
-
-std::vector<std::string>       g_joint_name_list;
-std::vector<action_script_cmd> g_action_script_data;
-
-std::string convertIntToString(int n)
-{
-  std::ostringstream ostr;
-  ostr << n;
-  return ostr.str();
-}
+thormang3::ActionScriptLibrary  g_action_script_library;
+thormang3::ScriptTimingProfiler g_script_timing_profiler;
 
 int convertStringToInt(std::string str)
 {
   return atoi(str.c_str());
 }
 
-bool isActionRunning(void)
+bool isActionRunning(int branch_index = 0)
 {
-  if (g_is_running_client.call(g_is_running_srv) == false)
+  ros::WallTime call_start_time = ros::WallTime::now();
+
+  // branches of a forked script can check the action status at the same time
+  boost::mutex::scoped_lock lock(g_is_running_mutex);
+  thormang3_action_module_msgs::IsRunning is_running_srv;
+
+  bool call_result = g_is_running_client.call(is_running_srv);
+  if (g_script_timing_profiler.isEnabled() == true)
+    g_script_timing_profiler.addServiceCall(branch_index, "is_running", call_start_time, ros::WallTime::now());
+
+  if (call_result == false)
   {
     ROS_ERROR("Failed to get action status");
     return true;
   }
   else
   {
-    if (g_is_running_srv.response.is_running == true)
+    if (is_running_srv.response.is_running == true)
     {
       return true;
     }
@@ -89,126 +88,152 @@ bool isActionRunning(void)
   return false;
 }
 
-bool parseActionScript(int action_script_index)
-{
-  g_action_script_data.clear();
+void playActionScriptBranch(boost::shared_ptr<const action_script> script, int branch_index,
+                            ros::WallTime scheduled_time);
 
-  YAML::Node action_script_file_doc;
+void actionScriptBranchThreadFunc(boost::shared_ptr<const action_script> script, int branch_index,
+                                  ros::WallTime scheduled_time)
+{
   try
   {
-    // load yaml
-    action_script_file_doc = YAML::LoadFile(g_action_script_file_path.c_str());
-  } catch (const std::exception& e)
+    playActionScriptBranch(script, branch_index, scheduled_time);
+  } catch (boost::thread_interrupted&)
   {
-    ROS_ERROR("Failed to load action script file.");
-    return false;
+    ROS_INFO_STREAM("Action Script Branch #" << branch_index << " is Interrupted");
   }
+}
 
-  //find action script
-  std::string script_index_key  = "script" + convertIntToString(action_script_index);
-  YAML::Node  action_script_doc = action_script_file_doc[script_index_key];
-  if (action_script_doc == NULL)
+void joinActionScriptBranches(std::vector<boost::shared_ptr<boost::thread> >& forked_threads,
+                              std::vector<int>& forked_branches)
+{
+  for (unsigned int thread_idx = 0; thread_idx < forked_threads.size(); thread_idx++)
   {
-    std::string status_msg = "Failed to find action script #" + convertIntToString(action_script_index);
-    ROS_ERROR_STREAM(status_msg);
-    return false;
+    if (forked_threads[thread_idx]->joinable() == true)
+      forked_threads[thread_idx]->join();
+    ROS_DEBUG_STREAM("Action Script Branch #" << forked_branches[thread_idx] << " is finished");
   }
 
-  int cmd_num = 1;
-  std::string cmd_key = "";
+  forked_threads.clear();
+  forked_branches.clear();
+}
+
+void interruptActionScriptBranches(std::vector<boost::shared_ptr<boost::thread> >& forked_threads,
+                                   std::vector<int>& forked_branches)
+{
+  for (unsigned int thread_idx = 0; thread_idx < forked_threads.size(); thread_idx++)
+    forked_threads[thread_idx]->interrupt();
+
+  // join() is an interruption point, so it is disabled while the branches are collected
+  boost::this_thread::disable_interruption disable_interruption;
+  joinActionScriptBranches(forked_threads, forked_branches);
+}
+
+// scheduled_time : start time of the next cmd when publishing and service calls take no time
+void playActionScriptBranch(boost::shared_ptr<const action_script> script, int branch_index,
+                            ros::WallTime scheduled_time)
+{
+  const action_script_branch& branch = script->branch_list[branch_index];
+
+  // branches forked by this sequence, they are joined by "join" or at the end of the sequence
+  std::vector<boost::shared_ptr<boost::thread> > forked_threads;
+  std::vector<int> forked_branches;
+
+  std_msgs::Int32   action_page_num_msg;
+  std_msgs::String  sound_file_name_msg;
+  thormang3_action_module_msgs::StartAction start_action_msg;
+  start_action_msg.joint_name_array = branch.joint_name_list;
+
   try
   {
-    g_joint_name_list.clear();
-    YAML::Node joint_name_doc = action_script_doc[JOINT_NAME_KEY];
-    if (joint_name_doc != NULL)
-      g_joint_name_list = joint_name_doc.as< std::vector<std::string> >();
-
-    while (true)
+    for (unsigned int cmd_idx = 0; cmd_idx < branch.cmd_list.size(); cmd_idx++)
     {
-      //check cmd exist
-      cmd_key = "cmd" + convertIntToString(cmd_num);
-      YAML::Node action_script_cmd_doc = action_script_doc[cmd_key];
-      if (action_script_cmd_doc == NULL)
-      {
-        break;
-      }
-
-      //check validity of cmd_name
-      action_script_cmd temp_cmd;
-      if (action_script_cmd_doc["cmd_name"] == NULL)
-      {
-        std::string status_msg = "cmd#" + convertIntToString(cmd_num) + " of " + "script#" + convertIntToString(action_script_index) + " is invalid.";
-        ROS_ERROR_STREAM(status_msg);
-        return false;
-      }
+      const action_script_cmd& cmd = branch.cmd_list[cmd_idx];
+      ros::WallTime cmd_start_time = ros::WallTime::now();
 
-      //check  validity of cmd_arg
-      temp_cmd.cmd_name = action_script_cmd_doc["cmd_name"].as<std::string>();
-      if ((temp_cmd.cmd_name != "wait") && (action_script_cmd_doc["cmd_arg"] == NULL))
+      boost::this_thread::interruption_point();
+      switch (cmd.cmd_type)
       {
-        std::string status_msg = "cmd#" + convertIntToString(cmd_num) + " of " + "script#" + convertIntToString(action_script_index) + " is invalid.";
-        ROS_ERROR_STREAM(status_msg);
-        return false;
+        case thormang3::ACTION_PLAY_CMD:
+          if (branch.joint_name_list.size() != 0)
+          {
+            start_action_msg.page_num = cmd.cmd_arg_int;
+            g_start_action_pub.publish(start_action_msg);
+          }
+          else
+          {
+            action_page_num_msg.data  = cmd.cmd_arg_int;
+            g_action_page_num_pub.publish(action_page_num_msg);
+          }
+          break;
+
+        case thormang3::MP3_PLAY_CMD:
+          sound_file_name_msg.data = cmd.cmd_arg_str;
+          g_sound_file_name_pub.publish(sound_file_name_msg);
+          break;
+
+        case thormang3::WAIT_ACTION_PLAY_FINISH_CMD:
+          while (true)
+          {
+            if (isActionRunning(branch_index) == false)
+              break;
+
+            boost::this_thread::sleep(boost::posix_time::milliseconds(32));
+          }
+          break;
+
+        case thormang3::SLEEP_CMD:
+          boost::this_thread::sleep(boost::posix_time::milliseconds(cmd.cmd_arg_int));
+          break;
+
+        case thormang3::FORK_CMD:
+          for (unsigned int fork_idx = 0; fork_idx < cmd.branch_index_list.size(); fork_idx++)
+          {
+            int sub_branch_index = cmd.branch_index_list[fork_idx];
+            forked_threads.push_back(boost::shared_ptr<boost::thread>(new boost::thread(actionScriptBranchThreadFunc,
+                                                                                        script, sub_branch_index,
+                                                                                        scheduled_time)));
+            forked_branches.push_back(sub_branch_index);
+          }
+          break;
+
+        case thormang3::JOIN_CMD:
+          joinActionScriptBranches(forked_threads, forked_branches);
+          break;
+
+        default:
+          boost::this_thread::interruption_point();
+          continue;
       }
 
-      //get cmd_arg
-      if (temp_cmd.cmd_name == ACTION_PLAY_CMD_NAME)
-      {
-        temp_cmd.cmd_arg_int = action_script_cmd_doc["cmd_arg"].as<int>();
-      }
-      else if (temp_cmd.cmd_name == MP3_PLAY_CMD_NAME)
-      {
-        temp_cmd.cmd_arg_str = action_script_cmd_doc["cmd_arg"].as<std::string>();
-      }
-      else if (temp_cmd.cmd_name == WAIT_ACTION_PLAY_FINISH_CMD_NAME)
-      {
-        temp_cmd.cmd_arg_str = "";
-        temp_cmd.cmd_arg_int = 0;
-      }
-      else if (temp_cmd.cmd_name == SLEEP_CMD_NAME)
-      {
-        temp_cmd.cmd_arg_int = action_script_cmd_doc["cmd_arg"].as<int>();
-        if (temp_cmd.cmd_arg_int < 0)
-        {
-          std::string status_msg = "cmd#" + convertIntToString(cmd_num) + " of " + "script#" + convertIntToString(action_script_index) + " is invalid.";
-          ROS_ERROR_STREAM(status_msg);
-          g_action_script_data.clear();
-          return false;
-        }
-      }
-      else
+      if (g_script_timing_profiler.isEnabled() == true)
       {
-        std::string status_msg = "cmd#" + convertIntToString(cmd_num) + " of " + "script#" + convertIntToString(action_script_index) + " is invalid.";
-        ROS_ERROR_STREAM(status_msg);
-        g_action_script_data.clear();
-        return false;
+        ros::WallTime cmd_end_time = ros::WallTime::now();
+        g_script_timing_profiler.addCommand(branch_index, cmd.cmd_key_path, cmd.cmd_name, cmd.cmd_arg_str, cmd.cmd_arg_int,
+                                            scheduled_time, cmd_start_time, cmd_end_time);
+
+        // a sleep is expected to take its time exactly,
+        // the time of wait and join depends on the motion, so the schedule restarts after them
+        if (cmd.cmd_type == thormang3::SLEEP_CMD)
+          scheduled_time = scheduled_time + ros::WallDuration(cmd.cmd_arg_int * 0.001);
+        else if ((cmd.cmd_type == thormang3::WAIT_ACTION_PLAY_FINISH_CMD) || (cmd.cmd_type == thormang3::JOIN_CMD))
+          scheduled_time = cmd_end_time;
       }
-
-      g_action_script_data.push_back(temp_cmd);
-      cmd_num++;
     }
-  } catch (const std::exception& e)
+
+    // barrier at the end of the sequence
+    joinActionScriptBranches(forked_threads, forked_branches);
+  } catch (boost::thread_interrupted&)
   {
-    std::string status_msg = "cmd#" + convertIntToString(cmd_num) + " of " + "script#" + convertIntToString(action_script_index) + " is invalid.";
-    ROS_ERROR_STREAM(status_msg);
-    g_action_script_data.clear();
-    return false;
+    interruptActionScriptBranches(forked_threads, forked_branches);
+    throw;
   }
-
-  return true;
 }
 
-void actionScriptPlayThreadFunc(int action_script_index)
+// script_key : name or number of the script
+void actionScriptPlayThreadFunc(std::string script_key)
 {
   try
   {
-    if (action_script_index < 0)
-    {
-      std::string status_msg = "Invalid Action Script Index";
-      ROS_ERROR_STREAM(status_msg);
-      return;
-    }
-
     if (isActionRunning() == true)
     {
       std::string status_msg = "Previous action playing is not finished.";
@@ -216,118 +241,86 @@ void actionScriptPlayThreadFunc(int action_script_index)
       return;
     }
 
-    if (parseActionScript(action_script_index) == false)
+    boost::shared_ptr<const action_script> script = g_action_script_library.getScript(script_key);
+    if (!script)
       return;
 
-    std_msgs::Int32   action_page_num_msg;
-    std_msgs::String  sound_file_name_msg;
-    thormang3_action_module_msgs::StartAction start_action_msg;
-    if (g_joint_name_list.size() != 0)
-    {
-      for (unsigned int joint_name_idx = 0; joint_name_idx < g_joint_name_list.size(); joint_name_idx++)
-        start_action_msg.joint_name_array.push_back(g_joint_name_list[joint_name_idx]);
-    }
-
-    for(unsigned int action_script_data_idx = 0; action_script_data_idx < g_action_script_data.size(); action_script_data_idx++)
-    {
-      std::string cmd_name = g_action_script_data[action_script_data_idx].cmd_name;
+    if (g_script_timing_profiler.isEnabled() == true)
+      g_script_timing_profiler.startRun(script->name);
 
-      boost::this_thread::interruption_point();
-      if (cmd_name == ACTION_PLAY_CMD_NAME)
-      {
-        if (g_joint_name_list.size() != 0)
-        {
-          start_action_msg.page_num = g_action_script_data[action_script_data_idx].cmd_arg_int;
-          g_start_action_pub.publish(start_action_msg);
-        }
-        else
-        {
-          action_page_num_msg.data  = g_action_script_data[action_script_data_idx].cmd_arg_int;
-          g_action_page_num_pub.publish(action_page_num_msg);
-        }
-      }
-      else if (cmd_name == MP3_PLAY_CMD_NAME)
-      {
-        sound_file_name_msg.data = g_action_script_data[action_script_data_idx].cmd_arg_str;
-        g_sound_file_name_pub.publish(sound_file_name_msg);
-      }
-      else if (cmd_name == WAIT_ACTION_PLAY_FINISH_CMD_NAME)
-      {
-        while (true)
-        {
-          if (isActionRunning() == false)
-            break;
+    playActionScriptBranch(script, 0, ros::WallTime::now());
 
-          boost::this_thread::sleep(boost::posix_time::milliseconds(32));
-        }
-      }
-      else if (cmd_name == SLEEP_CMD_NAME)
-      {
-        boost::this_thread::sleep(boost::posix_time::milliseconds(g_action_script_data[action_script_data_idx].cmd_arg_int));
-      }
-      else
-      {
-        boost::this_thread::interruption_point();
-        continue;
-      }
-    }
+    if (g_script_timing_profiler.isEnabled() == true)
+      g_script_timing_profiler.finishRun();
 
   } catch (boost::thread_interrupted&)
   {
     ROS_INFO("Action Script Thread is Interrupted");
+
+    if (g_script_timing_profiler.isEnabled() == true)
+      g_script_timing_profiler.finishRun();
     return;
   }
 }
 
+void stopActionScript(int stop_cmd)
+{
+  std_msgs::Int32   action_page_num_msg;
+  action_page_num_msg.data = stop_cmd;
+  g_action_page_num_pub.publish(action_page_num_msg);
+
+  if ((g_action_script_play_thread != 0))
+  {
+    g_action_script_play_thread->interrupt();
+    g_action_script_play_thread->join();
+    delete g_action_script_play_thread;
+    g_action_script_play_thread = 0;
+  }
+}
+
+void startActionScript(const std::string& script_key)
+{
+  if ((g_action_script_play_thread == 0))
+  {
+    g_action_script_play_thread = new boost::thread(actionScriptPlayThreadFunc, script_key);
+  }
+  else if (g_action_script_play_thread->timed_join(boost::posix_time::milliseconds(32)) == true)
+  {
+    delete g_action_script_play_thread;
+    g_action_script_play_thread = new boost::thread(actionScriptPlayThreadFunc, script_key);
+  }
+  else
+  {
+    std::string status_msg = "Previous action script is not finished.";
+    ROS_ERROR_STREAM(status_msg);
+  }
+}
+
 void actionScriptNumberCallback(const std_msgs::Int32::ConstPtr& msg)
 {
   if ((msg->data == -1) || (msg->data == -2))  //Stop or Break
   {
-    std_msgs::Int32   action_page_num_msg;
-    action_page_num_msg.data = msg->data;
-    g_action_page_num_pub.publish(action_page_num_msg);
-
-//    if((g_action_script_play_thread != 0)	&& (g_action_script_play_thread->get_thread_info() != 0))
-//    {
-//      if(g_action_script_play_thread->get_thread_info()->done == false)
-//      {
-//        g_action_script_play_thread->interrupt();
-//        g_action_script_play_thread->join();
-//      }
-//    }
-    if ((g_action_script_play_thread != 0))
-    {
-      g_action_script_play_thread->interrupt();
-      g_action_script_play_thread->join();
-      delete g_action_script_play_thread;
-      g_action_script_play_thread = 0;
-    }
+    stopActionScript(msg->data);
+  }
+  else if (msg->data < 0)
+  {
+    std::string status_msg = "Invalid Action Script Index";
+    ROS_ERROR_STREAM(status_msg);
   }
   else
   {
-    if ((g_action_script_play_thread == 0))
-    {
-      g_action_script_play_thread = new boost::thread(actionScriptPlayThreadFunc, msg->data);
-    }
-//    else if(g_action_script_play_thread->get_thread_info() == 0)
-//    {
-//      g_action_script_play_thread = new boost::thread(actionScriptPlayThreadFunc, msg->data);
-//    }
-    //else if(g_action_script_play_thread->get_thread_info()->done == true)
-    //else if(g_action_script_play_thread->get_id() == false)
-    else if (g_action_script_play_thread->timed_join(boost::posix_time::milliseconds(32)) == true)
-    {
-      delete g_action_script_play_thread;
-      g_action_script_play_thread = new boost::thread(actionScriptPlayThreadFunc, msg->data);
-    }
-    else
-    {
-      std::string status_msg = "Previous action script is not finished.";
-      ROS_ERROR_STREAM(status_msg);
-    }
+    startActionScript(convertIntToString(msg->data));
   }
 }
 
+void actionScriptNameCallback(const std_msgs::String::ConstPtr& msg)
+{
+  if ((msg->data == "-1") || (msg->data == "-2"))  //Stop or Break
+    stopActionScript(convertStringToInt(msg->data));
+  else
+    startActionScript(msg->data);
+}
+
 int main(int argc, char **argv)
 {
   ros::init(argc, argv, "thormang3_action_script_player");
@@ -336,6 +329,7 @@ int main(int argc, char **argv)
   g_action_script_play_thread = 0;
 
   g_action_script_num_sub = ros_node_handle.subscribe("/robotis/demo/action_index", 0, &actionScriptNumberCallback);
+  g_action_script_name_sub = ros_node_handle.subscribe("/robotis/demo/action_script_name", 0, &actionScriptNameCallback);
   g_action_page_num_pub   = ros_node_handle.advertise<std_msgs::Int32>("/robotis/action/page_num", 0);
   g_start_action_pub      = ros_node_handle.advertise<thormang3_action_module_msgs::StartAction>("/robotis/action/start_action", 0);
   g_sound_file_name_pub   = ros_node_handle.advertise<std_msgs::String>("/play_sound_file", 0);
@@ -350,6 +344,22 @@ int main(int argc, char **argv)
     ROS_WARN("The default action script file path will be used.");
   }
 
+  //Index action script files, the scripts in action_script_file_path take precedence over the directory
+  g_action_script_library.addFile(g_action_script_file_path);
+  if (ros_node_handle.getParam("action_script_dir_path", g_action_script_dir_path) == true)
+  {
+    int file_count = g_action_script_library.addDirectory(g_action_script_dir_path);
+    ROS_INFO_STREAM(file_count << " action script files are indexed in " << g_action_script_dir_path);
+  }
+  ROS_INFO_STREAM(g_action_script_library.getScriptCount() << " action scripts are available");
+
+  //Setting script timing profile, it is disabled when the output path is empty
+  std::string profile_path   = ros_node_handle.param<std::string>("script_profile_path", "");
+  std::string profile_format = ros_node_handle.param<std::string>("script_profile_format", "json");
+  g_script_timing_profiler.setOutput(profile_path, profile_format);
+  if (profile_path != "")
+    ROS_INFO_STREAM("Script timing profile will be saved in " << profile_path << " [" << profile_format << "]");
+
   ROS_INFO("Start ThorMang3 Action Script Player");
 
   ros::spin();
@@ -0,0 +1,657 @@
+/*******************************************************************************
+* Copyright 2018 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+/*
+ * action_script_validator.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <set>
+#include <ros/ros.h>
+#include <ros/package.h>
+#include <boost/thread.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/algorithm/string.hpp>
+#include "thormang3_action_script_player/action_script.h"
+
+using namespace thormang3;
+
+// page layout of the action file of thormang3_action_module (action_file_define)
+#define ACTION_FILE_PAGE_NUM        256
+#define PAGE_HEADER_STEP_NUM_OFFSET 20
+
+typedef struct
+{
+  int                 file_index;
+  action_script_block block;
+} validation_job;
+
+typedef struct
+{
+  int         file_index;
+  int         line;         // 0-based
+  bool        is_error;
+  std::string message;
+} validation_report;
+
+std::vector<std::string>                     g_file_path_list;
+std::vector<std::string>                     g_file_text_list;
+std::vector<validation_job>                  g_job_list;
+std::vector<std::vector<validation_report> > g_job_report_list;   // each worker writes only the reports of its job
+std::map<std::string, int>                   g_script_name_map;   // script key or name -> g_job_list index
+
+std::vector<unsigned char> g_page_step_num_list;   // empty when the action file is not available
+
+boost::mutex g_job_mutex;
+unsigned int g_next_job_index = 0;
+
+void addReport(std::vector<validation_report>* report_list, int file_index, int line, bool is_error,
+               const std::string& message)
+{
+  validation_report report;
+  report.file_index = file_index;
+  report.line       = line;
+  report.is_error   = is_error;
+  report.message    = message;
+  report_list->push_back(report);
+}
+
+// "cmd12" with prefix "cmd" -> 12, otherwise -1
+int getKeyNumber(const std::string& key, const std::string& prefix)
+{
+  if ((key.size() <= prefix.size()) || (key.compare(0, prefix.size(), prefix) != 0)
+      || (key.find_first_not_of("0123456789", prefix.size()) != std::string::npos))
+    return -1;
+
+  return atoi(key.c_str() + prefix.size());
+}
+
+// finds the keys of key_path one after another in the script block text, returns the line in the block
+int findKeyLine(const std::string& block_text, const std::vector<std::string>& key_path)
+{
+  // indent of the first level of the script
+  std::size_t first_level_indent = std::string::npos;
+  for (std::size_t line_begin = block_text.find('\n'); line_begin != std::string::npos;
+       line_begin = block_text.find('\n', line_begin + 1))
+  {
+    std::size_t text_begin = block_text.find_first_not_of(" \t", line_begin + 1);
+    if ((text_begin != std::string::npos) && (block_text[text_begin] != '\n') && (block_text[text_begin] != '\r')
+        && (block_text[text_begin] != '#'))
+    {
+      first_level_indent = text_begin - line_begin - 1;
+      break;
+    }
+  }
+
+  std::size_t key_pos = 0;
+  std::size_t search_pos = 0;
+  for (unsigned int key_idx = 0; key_idx < key_path.size(); key_idx++)
+  {
+    std::string key = key_path[key_idx] + ":";
+    std::size_t found_pos = search_pos;
+    while (true)
+    {
+      found_pos = block_text.find(key, found_pos);
+      if (found_pos == std::string::npos)
+        break;
+
+      // skip "xcmd1:" and commented keys, the first key is on the first level of the script
+      char prev_char = (found_pos == 0) ? ' ' : block_text[found_pos - 1];
+      std::size_t line_begin = block_text.rfind('\n', found_pos);
+      line_begin = (line_begin == std::string::npos) ? 0 : line_begin + 1;
+      std::string line_head = block_text.substr(line_begin, found_pos - line_begin);
+      bool is_comment = (line_head.find('#') != std::string::npos);
+      bool is_first_level = (line_head.size() == first_level_indent)
+          && (line_head.find_first_not_of(" \t") == std::string::npos);
+
+      if ((isalnum(prev_char) == 0) && (prev_char != '_') && (is_comment == false)
+          && ((key_idx != 0) || (is_first_level == true)))
+        break;
+
+      found_pos += key.size();
+    }
+
+    if (found_pos == std::string::npos)
+      break;
+
+    key_pos = found_pos;
+    search_pos = found_pos + key.size();
+  }
+
+  return std::count(block_text.begin(), block_text.begin() + key_pos, '\n');
+}
+
+enum KeyLevel
+{
+  SCRIPT_KEY_LEVEL = 0,
+  INSTANCE_KEY_LEVEL = 1,   // script with a template
+  BRANCH_KEY_LEVEL = 2,
+  CMD_KEY_LEVEL = 3,
+  LOOP_KEY_LEVEL = 4
+};
+
+// reports the keys that the player does not read, such as a typo or cmd4 after a missing cmd3
+void checkIgnoredKeys(const YAML::Node& doc, int key_level, const std::vector<std::string>& key_path,
+                      const validation_job& job, const std::string& block_text,
+                      std::vector<validation_report>* report_list)
+{
+  if (doc.IsMap() == false)
+    return;
+
+  if ((key_level == CMD_KEY_LEVEL) && (doc["cmd_name"] != NULL) && (doc["cmd_name"].as<std::string>() == LOOP_CMD_NAME))
+    key_level = LOOP_KEY_LEVEL;
+
+  // cmd1, cmd2, ... of a script, a branch and a loop, branch1, branch2, ... of a fork
+  std::string sequence_prefix = (key_level == CMD_KEY_LEVEL) ? BRANCH_KEY : "cmd";
+  int sequence_level = (key_level == CMD_KEY_LEVEL) ? BRANCH_KEY_LEVEL : CMD_KEY_LEVEL;
+
+  int sequence_count = 0;
+  while ((key_level != INSTANCE_KEY_LEVEL) && (doc[sequence_prefix + convertIntToString(sequence_count + 1)] != NULL))
+    sequence_count++;
+
+  for (YAML::const_iterator key_it = doc.begin(); key_it != doc.end(); ++key_it)
+  {
+    std::string key = key_it->first.as<std::string>();
+    std::vector<std::string> sub_key_path = key_path;
+    sub_key_path.push_back(key);
+
+    int key_line = job.block.begin_line + findKeyLine(block_text, sub_key_path);
+    int sequence_num = getKeyNumber(key, sequence_prefix);
+
+    bool is_known_key = false;
+    switch (key_level)
+    {
+      case SCRIPT_KEY_LEVEL:
+        is_known_key = (key == JOINT_NAME_KEY) || (key == SCRIPT_NAME_KEY) || (key == PARAMS_KEY);
+        break;
+      case INSTANCE_KEY_LEVEL:
+        is_known_key = (key == SCRIPT_NAME_KEY) || (key == TEMPLATE_KEY) || (key == PARAMS_KEY);
+        break;
+      case BRANCH_KEY_LEVEL:
+        is_known_key = (key == JOINT_NAME_KEY);
+        break;
+      default:
+        is_known_key = (key == "cmd_name") || (key == "cmd_arg");
+        break;
+    }
+
+    if (is_known_key == true)
+      continue;
+
+    if ((key_level == INSTANCE_KEY_LEVEL) || (sequence_num < 0))
+    {
+      addReport(report_list, job.file_index, key_line, false,
+                "unknown key [" + key + "] of " + job.block.key + " is ignored.");
+    }
+    else if ((sequence_num == 0) || (sequence_num > sequence_count))
+    {
+      addReport(report_list, job.file_index, key_line, false,
+                key + " of " + job.block.key + " is ignored because " + sequence_prefix
+                    + convertIntToString(sequence_count + 1) + " is missing.");
+    }
+    else
+    {
+      checkIgnoredKeys(key_it->second, sequence_level, sub_key_path, job, block_text, report_list);
+    }
+  }
+}
+
+// checks the page of play cmds and join cmds without fork.
+// block_text is NULL for an instance of a template, its cmds are reported on the line of the instance
+void checkBranch(const action_script& script, int branch_index, const std::string& script_desc,
+                 const validation_job& job, const std::string* block_text,
+                 std::set<std::string>* reported_cmd_list, std::vector<validation_report>* report_list)
+{
+  const std::vector<action_script_cmd>& cmd_list = script.branch_list[branch_index].cmd_list;
+
+  bool is_forked = false;
+  for (unsigned int cmd_idx = 0; cmd_idx < cmd_list.size(); cmd_idx++)
+  {
+    const action_script_cmd& cmd = cmd_list[cmd_idx];
+
+    std::string report_msg = "";
+    bool is_error = true;
+    if (cmd.cmd_type == ACTION_PLAY_CMD)
+    {
+      if ((cmd.cmd_arg_int <= 0) || (cmd.cmd_arg_int >= ACTION_FILE_PAGE_NUM))
+        report_msg = " plays page " + convertIntToString(cmd.cmd_arg_int) + " which is out of range.";
+      else if ((g_page_step_num_list.size() != 0) && (g_page_step_num_list[cmd.cmd_arg_int] == 0))
+        report_msg = " plays page " + convertIntToString(cmd.cmd_arg_int) + " which is empty.";
+    }
+    else if (cmd.cmd_type == FORK_CMD)
+    {
+      is_forked = true;
+      for (unsigned int branch_idx = 0; branch_idx < cmd.branch_index_list.size(); branch_idx++)
+        checkBranch(script, cmd.branch_index_list[branch_idx], script_desc, job, block_text, reported_cmd_list,
+                    report_list);
+    }
+    else if (cmd.cmd_type == JOIN_CMD)
+    {
+      if (is_forked == false)
+      {
+        report_msg = " has no branch to join.";
+        is_error = false;
+      }
+      is_forked = false;
+    }
+
+    // a cmd in a loop is reported once, the warnings of a template are reported by the template
+    if ((report_msg == "") || ((block_text == NULL) && (is_error == false))
+        || (reported_cmd_list->insert(cmd.cmd_key_path).second == false))
+      continue;
+
+    int cmd_line = job.block.begin_line;
+    if (block_text != NULL)
+    {
+      std::vector<std::string> cmd_key_path;
+      boost::split(cmd_key_path, cmd.cmd_key_path, boost::is_any_of("/"));
+      cmd_line += findKeyLine(*block_text, cmd_key_path);
+    }
+
+    addReport(report_list, job.file_index, cmd_line, is_error, cmd.cmd_key_path + " of " + script_desc + report_msg);
+  }
+}
+
+bool loadScriptDoc(const validation_job& job, YAML::Node* script_doc, std::vector<validation_report>* report_list)
+{
+  const action_script_block& block = job.block;
+  try
+  {
+    YAML::Node block_doc = YAML::Load(g_file_text_list[job.file_index].substr(block.begin, block.end - block.begin));
+    *script_doc = block_doc[block.key];
+  } catch (const YAML::Exception& e)
+  {
+    if (report_list != NULL)
+      addReport(report_list, job.file_index, block.begin_line + e.mark.line, true,
+                block.key + " is not valid yaml : " + e.msg);
+    return false;
+  }
+
+  if ((*script_doc == NULL) || (script_doc->IsMap() == false))
+  {
+    if (report_list != NULL)
+      addReport(report_list, job.file_index, block.begin_line, true, block.key + " has no cmd.");
+    return false;
+  }
+
+  return true;
+}
+
+// resolves the template with the params of the instance,
+// the errors of the template itself are reported by the template
+void validateInstance(const validation_job& job, const YAML::Node& script_doc,
+                      std::vector<validation_report>* report_list)
+{
+  const action_script_block& block = job.block;
+
+  std::string template_key = "";
+  action_script_params instance_params;
+  try
+  {
+    template_key = script_doc[TEMPLATE_KEY].as<std::string>();
+  } catch (const YAML::Exception& e)
+  {
+  }
+
+  if (readActionScriptParams(script_doc, &instance_params) == false)
+  {
+    addReport(report_list, job.file_index, block.begin_line, true,
+              std::string(PARAMS_KEY) + " of " + block.key + " is invalid.");
+    return;
+  }
+
+  std::map<std::string, int>::const_iterator template_it = g_script_name_map.find(template_key);
+  YAML::Node template_doc;
+  if ((template_it == g_script_name_map.end()) || (loadScriptDoc(g_job_list[template_it->second], &template_doc,
+                                                                 NULL) == false))
+  {
+    addReport(report_list, job.file_index, block.begin_line, true,
+              "template [" + template_key + "] of " + block.key + " is not found.");
+    return;
+  }
+
+  if (template_doc[TEMPLATE_KEY] != NULL)
+  {
+    addReport(report_list, job.file_index, block.begin_line, true,
+              "template [" + template_key + "] of " + block.key + " is an instance of another template.");
+    return;
+  }
+
+  action_script_params template_params;
+  readActionScriptParams(template_doc, &template_params);
+  for (action_script_params::iterator param_it = instance_params.begin(); param_it != instance_params.end();
+       ++param_it)
+  {
+    if (template_params.find(param_it->first) == template_params.end())
+      addReport(report_list, job.file_index, block.begin_line, false,
+                "param [" + param_it->first + "] of " + block.key + " is not declared in template [" + template_key
+                    + "].");
+  }
+
+  std::string instance_desc = template_key + " for " + block.key;
+  action_script script;
+  action_script_error error;
+  if (parseActionScript(template_doc, instance_desc, instance_params, &script, &error) == false)
+  {
+    addReport(report_list, job.file_index, block.begin_line, true, error.message);
+    return;
+  }
+
+  std::set<std::string> reported_cmd_list;
+  checkBranch(script, 0, instance_desc, job, NULL, &reported_cmd_list, report_list);
+}
+
+void validateScript(const validation_job& job, std::vector<validation_report>* report_list)
+{
+  const action_script_block& block = job.block;
+  std::string block_text = g_file_text_list[job.file_index].substr(block.begin, block.end - block.begin);
+
+  YAML::Node script_doc;
+  if (loadScriptDoc(job, &script_doc, report_list) == false)
+    return;
+
+  bool is_instance = (script_doc[TEMPLATE_KEY] != NULL);
+  try
+  {
+    checkIgnoredKeys(script_doc, (is_instance == true) ? INSTANCE_KEY_LEVEL : SCRIPT_KEY_LEVEL,
+                     std::vector<std::string>(), job, block_text, report_list);
+  } catch (const YAML::Exception& e)
+  {
+    // the keys are not strings, the parser reports it
+  }
+
+  if (is_instance == true)
+  {
+    validateInstance(job, script_doc, report_list);
+    return;
+  }
+
+  action_script script;
+  action_script_error error;
+  if (parseActionScript(script_doc, block.key, &script, &error) == false)
+  {
+    addReport(report_list, job.file_index, block.begin_line + findKeyLine(block_text, error.key_path), true,
+              error.message);
+    return;
+  }
+
+  if (script.branch_list[0].cmd_list.size() == 0)
+    addReport(report_list, job.file_index, block.begin_line, false, block.key + " has no cmd.");
+
+  std::set<std::string> reported_cmd_list;
+  checkBranch(script, 0, block.key, job, &block_text, &reported_cmd_list, report_list);
+}
+
+void validationThreadFunc()
+{
+  while (true)
+  {
+    unsigned int job_index;
+    {
+      boost::mutex::scoped_lock lock(g_job_mutex);
+      if (g_next_job_index >= g_job_list.size())
+        return;
+      job_index = g_next_job_index++;
+    }
+
+    validateScript(g_job_list[job_index], &g_job_report_list[job_index]);
+  }
+}
+
+bool loadActionFile(const std::string& action_file_path)
+{
+  std::ifstream action_file(action_file_path.c_str(), std::ios::binary);
+  if (action_file.is_open() == false)
+    return false;
+
+  std::string data((std::istreambuf_iterator<char>(action_file)), std::istreambuf_iterator<char>());
+  std::size_t page_size = data.size() / ACTION_FILE_PAGE_NUM;
+  if ((data.size() % ACTION_FILE_PAGE_NUM != 0) || (page_size <= PAGE_HEADER_STEP_NUM_OFFSET))
+    return false;
+
+  g_page_step_num_list.resize(ACTION_FILE_PAGE_NUM);
+  for (int page_idx = 0; page_idx < ACTION_FILE_PAGE_NUM; page_idx++)
+    g_page_step_num_list[page_idx] = data[page_idx * page_size + PAGE_HEADER_STEP_NUM_OFFSET];
+
+  return true;
+}
+
+bool addScriptFile(const std::string& file_path)
+{
+  std::ifstream script_file(file_path.c_str(), std::ios::binary);
+  if (script_file.is_open() == false)
+    return false;
+
+  std::string text((std::istreambuf_iterator<char>(script_file)), std::istreambuf_iterator<char>());
+
+  g_file_path_list.push_back(file_path);
+  g_file_text_list.push_back(text);
+  return true;
+}
+
+// returns the number of the paths that could not be read
+int addScriptPath(const std::string& path)
+{
+  int read_error_count = 0;
+  std::vector<std::string> file_list;
+  try
+  {
+    if (boost::filesystem::is_directory(path) == false)
+    {
+      if (addScriptFile(path) == true)
+        return 0;
+
+      fprintf(stderr, "%s: error: failed to read the file.\n", path.c_str());
+      return 1;
+    }
+
+    boost::filesystem::directory_iterator end_it;
+    for (boost::filesystem::directory_iterator dir_it(path); dir_it != end_it; ++dir_it)
+    {
+      std::string extension = dir_it->path().extension().string();
+      if (boost::filesystem::is_regular_file(dir_it->status()) && ((extension == ".yaml") || (extension == ".yml")))
+        file_list.push_back(dir_it->path().string());
+    }
+  } catch (const boost::filesystem::filesystem_error& e)
+  {
+    fprintf(stderr, "%s: error: %s\n", path.c_str(), e.code().message().c_str());
+    return 1;
+  }
+
+  // same order as the player
+  std::sort(file_list.begin(), file_list.end());
+  for (unsigned int file_idx = 0; file_idx < file_list.size(); file_idx++)
+  {
+    if (addScriptFile(file_list[file_idx]) == false)
+    {
+      fprintf(stderr, "%s: error: failed to read the file.\n", file_list[file_idx].c_str());
+      read_error_count++;
+    }
+  }
+
+  return read_error_count;
+}
+
+// the player plays the first one of the duplicated keys, names and numbers
+void indexScripts(std::vector<validation_report>* report_list)
+{
+  std::map<std::string, int>& name_map = g_script_name_map;
+  std::map<int, int> number_map;
+
+  for (unsigned int job_idx = 0; job_idx < g_job_list.size(); job_idx++)
+  {
+    const validation_job& job = g_job_list[job_idx];
+
+    std::vector<std::string> name_list;
+    name_list.push_back(job.block.key);
+    if (job.block.name != "")
+      name_list.push_back(job.block.name);
+
+    for (unsigned int name_idx = 0; name_idx < name_list.size(); name_idx++)
+    {
+      std::map<std::string, int>::iterator name_it = name_map.find(name_list[name_idx]);
+      if (name_it == name_map.end())
+      {
+        name_map[name_list[name_idx]] = job_idx;
+        continue;
+      }
+
+      const validation_job& first_job = g_job_list[name_it->second];
+      addReport(report_list, job.file_index, job.block.begin_line, true,
+                "script name [" + name_list[name_idx] + "] is already used at " + g_file_path_list[first_job.file_index]
+                    + ":" + convertIntToString(first_job.block.begin_line + 1) + ".");
+    }
+
+    int number = getScriptNumberFromKey(job.block.key);
+    if (number < 0)
+      continue;
+
+    std::map<int, int>::iterator number_it = number_map.find(number);
+    if (number_it == number_map.end())
+    {
+      number_map[number] = job_idx;
+      continue;
+    }
+
+    const validation_job& first_job = g_job_list[number_it->second];
+    addReport(report_list, job.file_index, job.block.begin_line, true,
+              "script #" + convertIntToString(number) + " is already used at " + g_file_path_list[first_job.file_index]
+                  + ":" + convertIntToString(first_job.block.begin_line + 1) + ".");
+  }
+}
+
+bool compareReport(const validation_report& report_a, const validation_report& report_b)
+{
+  if (report_a.file_index != report_b.file_index)
+    return report_a.file_index < report_b.file_index;
+  return report_a.line < report_b.line;
+}
+
+void printUsage()
+{
+  printf("Usage: thormang3_action_script_validator [-a action_file] [-j thread_num] script_file_or_dir ...\n");
+  printf("  -a : action file to check the pages of play cmds\n");
+  printf("       (default : data/motion_4095.bin of thormang3_action_module)\n");
+  printf("  -j : number of parsing threads (default : number of cores)\n");
+}
+
+int main(int argc, char **argv)
+{
+  std::string action_file_path = "";
+  int thread_num = boost::thread::hardware_concurrency();
+  std::vector<std::string> path_list;
+
+  for (int arg_idx = 1; arg_idx < argc; arg_idx++)
+  {
+    std::string arg = argv[arg_idx];
+    if ((arg == "-a") && (arg_idx + 1 < argc))
+      action_file_path = argv[++arg_idx];
+    else if ((arg == "-j") && (arg_idx + 1 < argc))
+      thread_num = atoi(argv[++arg_idx]);
+    else if ((arg == "-h") || (arg == "--help") || (arg[0] == '-'))
+    {
+      printUsage();
+      return 2;
+    }
+    else
+      path_list.push_back(arg);
+  }
+
+  if (path_list.size() == 0)
+  {
+    printUsage();
+    return 2;
+  }
+
+  if (thread_num < 1)
+    thread_num = 1;
+
+  ros::WallTime start_time = ros::WallTime::now();
+
+  //Setting action file
+  if (action_file_path == "")
+  {
+    std::string action_module_path = ros::package::getPath("thormang3_action_module");
+    if (action_module_path != "")
+      action_file_path = action_module_path + "/data/motion_4095.bin";
+  }
+
+  if (action_file_path == "")
+    printf("Action file is not available, only the range of the pages is checked.\n");
+  else if (loadActionFile(action_file_path) == false)
+    printf("Failed to read the action file [%s], only the range of the pages is checked.\n", action_file_path.c_str());
+
+  //Read script files and split the scripts
+  int read_error_count = 0;
+  for (unsigned int path_idx = 0; path_idx < path_list.size(); path_idx++)
+    read_error_count += addScriptPath(path_list[path_idx]);
+
+  for (unsigned int file_idx = 0; file_idx < g_file_text_list.size(); file_idx++)
+  {
+    std::vector<action_script_block> block_list;
+    scanActionScriptBlocks(g_file_text_list[file_idx].data(), g_file_text_list[file_idx].size(), &block_list);
+
+    for (unsigned int block_idx = 0; block_idx < block_list.size(); block_idx++)
+    {
+      validation_job job;
+      job.file_index = file_idx;
+      job.block      = block_list[block_idx];
+      g_job_list.push_back(job);
+    }
+  }
+
+  //Validate scripts in parallel, the workers only read the name index of the templates
+  std::vector<validation_report> report_list;
+  indexScripts(&report_list);
+  g_job_report_list.resize(g_job_list.size());
+
+  boost::thread_group validation_threads;
+  for (int thread_idx = 0; thread_idx < thread_num; thread_idx++)
+    validation_threads.create_thread(&validationThreadFunc);
+  validation_threads.join_all();
+
+  for (unsigned int job_idx = 0; job_idx < g_job_report_list.size(); job_idx++)
+    report_list.insert(report_list.end(), g_job_report_list[job_idx].begin(), g_job_report_list[job_idx].end());
+
+  std::stable_sort(report_list.begin(), report_list.end(), compareReport);
+
+  //Print reports like compiler messages
+  int error_count = read_error_count;
+  int warning_count = 0;
+  for (unsigned int report_idx = 0; report_idx < report_list.size(); report_idx++)
+  {
+    const validation_report& report = report_list[report_idx];
+    printf("%s:%d: %s: %s\n", g_file_path_list[report.file_index].c_str(), report.line + 1,
+           (report.is_error == true) ? "error" : "warning", report.message.c_str());
+
+    if (report.is_error == true)
+      error_count++;
+    else
+      warning_count++;
+  }
+
+  double elapsed_ms = (ros::WallTime::now() - start_time).toSec() * 1000.0;
+  printf("%d scripts in %d files : %d errors, %d warnings (%.1f ms)\n", (int) g_job_list.size(),
+         (int) g_file_path_list.size(), error_count, warning_count, elapsed_ms);
+
+  return (error_count == 0) ? 0 : 1;
+}
@@ -0,0 +1,267 @@
+/*******************************************************************************
+* Copyright 2018 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+/*
+ * script_timing_profiler.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include <fstream>
+#include <sstream>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include "thormang3_action_script_player/script_timing_profiler.h"
+
+using namespace thormang3;
+
+ScriptTimingProfiler::ScriptTimingProfiler()
+  : output_dir_(""),
+    output_format_("json"),
+    script_name_(""),
+    is_running_(false)
+{
+}
+
+ScriptTimingProfiler::~ScriptTimingProfiler()
+{
+}
+
+void ScriptTimingProfiler::setOutput(const std::string& output_dir, const std::string& output_format)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+
+  output_dir_ = output_dir;
+  if (output_format == "csv")
+    output_format_ = "csv";
+  else
+    output_format_ = "json";
+}
+
+bool ScriptTimingProfiler::isEnabled() const
+{
+  return (output_dir_ != "");
+}
+
+void ScriptTimingProfiler::startRun(const std::string& script_name)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+
+  script_name_    = script_name;
+  run_start_time_ = ros::WallTime::now();
+  is_running_     = true;
+  records_.clear();
+}
+
+void ScriptTimingProfiler::addCommand(int branch_index, const std::string& cmd_key_path, const std::string& cmd_name,
+                                      const std::string& cmd_arg_str, int cmd_arg_int,
+                                      const ros::WallTime& scheduled_time, const ros::WallTime& start_time,
+                                      const ros::WallTime& end_time)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  if (is_running_ == false)
+    return;
+
+  timing_record record;
+  record.type         = COMMAND_RECORD;
+  record.branch_index = branch_index;
+  record.cmd_key_path = cmd_key_path;
+  record.name         = cmd_name;
+  record.arg_str      = cmd_arg_str;
+  record.arg_int      = cmd_arg_int;
+  record.scheduled_us = toRunTimeUS(scheduled_time);
+  record.start_us     = toRunTimeUS(start_time);
+  record.end_us       = toRunTimeUS(end_time);
+
+  records_.push_back(record);
+}
+
+void ScriptTimingProfiler::addServiceCall(int branch_index, const std::string& service_name,
+                                          const ros::WallTime& start_time, const ros::WallTime& end_time)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  if (is_running_ == false)
+    return;
+
+  timing_record record;
+  record.type         = SERVICE_CALL_RECORD;
+  record.branch_index = branch_index;
+  record.cmd_key_path = "";
+  record.name         = service_name;
+  record.arg_int      = 0;
+  record.start_us     = toRunTimeUS(start_time);
+  record.scheduled_us = record.start_us;
+  record.end_us       = toRunTimeUS(end_time);
+
+  records_.push_back(record);
+}
+
+bool ScriptTimingProfiler::finishRun()
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  if (is_running_ == false)
+    return false;
+
+  is_running_ = false;
+
+  // summary
+  int64_t run_end_us = 0, cmd_lag_us = 0, blocked_us = 0, wait_us = 0;
+  for (unsigned int record_idx = 0; record_idx < records_.size(); record_idx++)
+  {
+    const timing_record& record = records_[record_idx];
+    if (record.end_us > run_end_us)
+      run_end_us = record.end_us;
+
+    if (record.type == SERVICE_CALL_RECORD)
+    {
+      blocked_us += record.end_us - record.start_us;
+    }
+    else
+    {
+      cmd_lag_us += record.start_us - record.scheduled_us;
+      if (record.name == "wait" || record.name == "join")
+        wait_us += record.end_us - record.start_us;
+    }
+  }
+
+  ROS_INFO_STREAM("[" << script_name_ << "] total : " << run_end_us * 0.001 << " ms, cmd lag : " << cmd_lag_us * 0.001
+                  << " ms, wait : " << wait_us * 0.001 << " ms, blocked in service : " << blocked_us * 0.001 << " ms");
+
+  // microseconds in the name, the runs finished in the same second do not overwrite each other
+  std::string file_path = output_dir_ + "/" + script_name_ + "_"
+      + boost::posix_time::to_iso_string(boost::posix_time::microsec_clock::local_time()) + "." + output_format_;
+
+  bool result = (output_format_ == "csv") ? writeCSV(file_path) : writeChromeTrace(file_path);
+  if (result == false)
+    ROS_ERROR_STREAM("Failed to write script timing profile : " << file_path);
+
+  records_.clear();
+  return result;
+}
+
+int64_t ScriptTimingProfiler::toRunTimeUS(const ros::WallTime& time) const
+{
+  return (time - run_start_time_).toNSec() / 1000;
+}
+
+std::string ScriptTimingProfiler::getArgString(const timing_record& record) const
+{
+  if (record.arg_str != "")
+    return record.arg_str;
+
+  if (record.type == SERVICE_CALL_RECORD || record.name == "wait" || record.name == "join" || record.name == "fork")
+    return "";
+
+  std::ostringstream ostr;
+  ostr << record.arg_int;
+  return ostr.str();
+}
+
+std::string ScriptTimingProfiler::escapeJsonString(const std::string& str) const
+{
+  static const char hex_digits[] = "0123456789abcdef";
+
+  std::string escaped;
+  for (unsigned int char_idx = 0; char_idx < str.size(); char_idx++)
+  {
+    unsigned char c = str[char_idx];
+    if (c == '"' || c == '\\')
+    {
+      escaped += '\\';
+      escaped += c;
+    }
+    else if (c == '\n')
+      escaped += "\\n";
+    else if (c == '\r')
+      escaped += "\\r";
+    else if (c == '\t')
+      escaped += "\\t";
+    else if (c < 0x20)
+    {
+      // other control characters are not allowed in a json string
+      escaped += "\\u00";
+      escaped += hex_digits[c >> 4];
+      escaped += hex_digits[c & 0x0f];
+    }
+    else
+      escaped += c;
+  }
+  return escaped;
+}
+
+// every text field is quoted, a script name or an arg can have commas, quotes or line breaks
+std::string ScriptTimingProfiler::quoteCSVString(const std::string& str) const
+{
+  std::string quoted = "\"";
+  for (unsigned int char_idx = 0; char_idx < str.size(); char_idx++)
+  {
+    if (str[char_idx] == '"')
+      quoted += '"';
+    quoted += str[char_idx];
+  }
+  quoted += '"';
+  return quoted;
+}
+
+bool ScriptTimingProfiler::writeChromeTrace(const std::string& file_path)
+{
+  std::ofstream trace_file(file_path.c_str());
+  if (trace_file.is_open() == false)
+    return false;
+
+  // one complete("X") event per record, a branch is shown as a thread
+  trace_file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << std::endl;
+  for (unsigned int record_idx = 0; record_idx < records_.size(); record_idx++)
+  {
+    const timing_record& record = records_[record_idx];
+
+    trace_file << "{\"name\":\"" << escapeJsonString(record.name) << "\",\"cat\":\""
+               << ((record.type == COMMAND_RECORD) ? "cmd" : "service") << "\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+               << record.branch_index << ",\"ts\":" << record.start_us << ",\"dur\":"
+               << (record.end_us - record.start_us) << ",\"args\":{";
+
+    if (record.type == COMMAND_RECORD)
+      trace_file << "\"cmd\":\"" << escapeJsonString(record.cmd_key_path) << "\",\"arg\":\""
+                 << escapeJsonString(getArgString(record))
+                 << "\",\"scheduled_us\":" << record.scheduled_us << ",\"lag_us\":"
+                 << (record.start_us - record.scheduled_us);
+
+    trace_file << "}}" << ((record_idx + 1 < records_.size()) ? "," : "") << std::endl;
+  }
+  trace_file << "]}" << std::endl;
+
+  return trace_file.good();
+}
+
+bool ScriptTimingProfiler::writeCSV(const std::string& file_path)
+{
+  std::ofstream csv_file(file_path.c_str());
+  if (csv_file.is_open() == false)
+    return false;
+
+  csv_file << "script,branch,cmd,name,arg,scheduled_ms,start_ms,end_ms,lag_ms,duration_ms" << std::endl;
+  for (unsigned int record_idx = 0; record_idx < records_.size(); record_idx++)
+  {
+    const timing_record& record = records_[record_idx];
+
+    csv_file << quoteCSVString(script_name_) << "," << record.branch_index << "," << quoteCSVString(record.cmd_key_path)
+             << "," << quoteCSVString(record.name) << "," << quoteCSVString(getArgString(record)) << ","
+             << record.scheduled_us * 0.001 << "," << record.start_us * 0.001 << ","
+             << record.end_us * 0.001 << "," << (record.start_us - record.scheduled_us) * 0.001 << ","
+             << (record.end_us - record.start_us) * 0.001 << std::endl;
+  }
+
+  return csv_file.good();
+}
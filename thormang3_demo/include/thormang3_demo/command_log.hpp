@@ -0,0 +1,137 @@
+/*******************************************************************************
+* Copyright 2018 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+/*****************************************************************************
+ ** Ifdefs
+ *****************************************************************************/
+
+#ifndef thormang3_demo_COMMAND_LOG_HPP_
+#define thormang3_demo_COMMAND_LOG_HPP_
+
+/*****************************************************************************
+ ** Includes
+ *****************************************************************************/
+#ifndef Q_MOC_RUN
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <ros/ros.h>
+#include <ros/serialization.h>
+#include <ros/message_traits.h>
+
+#endif // Q_MOC_RUN
+
+/*****************************************************************************
+ ** Namespaces
+ *****************************************************************************/
+
+namespace thormang3_demo
+{
+
+/*****************************************************************************
+ ** Class
+ *****************************************************************************/
+
+/**
+ * @brief Binary log of the published commands with their times.
+ *
+ * File : magic, version, then the records. A topic record gives the id,
+ * name, data type and md5sum of a topic at its first message, a message
+ * record has the topic id, the time from the start of the log in ns and
+ * the serialized message. The numbers are in the byte order of the host.
+ */
+class CommandLogWriter
+{
+ public:
+  CommandLogWriter();
+  ~CommandLogWriter();
+
+  bool open(const std::string &path);
+  void close();
+  bool isOpen() const
+  {
+    return file_.is_open();
+  }
+
+  // false if the file can not be written, e.g. the disk is full
+  template<class Message>
+  bool write(const std::string &topic, const Message &msg)
+  {
+    uint32_t size = ros::serialization::serializationLength(msg);
+    buffer_.resize(size);
+
+    if (size > 0)
+    {
+      ros::serialization::OStream stream(&buffer_[0], size);
+      ros::serialization::serialize(stream, msg);
+    }
+
+    return writeMessage(topic, ros::message_traits::datatype(msg), ros::message_traits::md5sum(msg), buffer_);
+  }
+
+ private:
+  bool writeMessage(const std::string &topic, const std::string &datatype, const std::string &md5sum,
+                    const std::vector<uint8_t> &data);
+  void writeString(const std::string &value);
+
+  std::ofstream file_;
+  ros::WallTime start_time_;
+  std::map<std::string, uint16_t> topic_id_table_;
+  std::vector<uint8_t> buffer_;
+};
+
+class CommandLogReader
+{
+ public:
+  struct Record
+  {
+    std::string topic;
+    std::string datatype;
+    std::string md5sum;
+    double time;  // sec from the start of the log
+    std::vector<uint8_t> data;
+  };
+
+  CommandLogReader();
+
+  bool open(const std::string &path);
+  void close();
+
+  // false at the end of the log or on a broken record
+  bool readNext(Record &record);
+
+ private:
+  struct Topic
+  {
+    std::string name;
+    std::string datatype;
+    std::string md5sum;
+  };
+
+  bool readString(std::string &value);
+  bool isReadable(uint32_t size);
+
+  std::ifstream file_;
+  std::streamoff file_size_;
+  std::vector<Topic> topic_list_;  // by topic id
+};
+
+}  // namespace thormang3_demo
+
+#endif /* thormang3_demo_COMMAND_LOG_HPP_ */
@@ -0,0 +1,96 @@
+/*******************************************************************************
+* Copyright 2018 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+/*****************************************************************************
+ ** Ifdefs
+ *****************************************************************************/
+
+#ifndef thormang3_demo_FOOTSTEP_PLAN_CACHE_HPP_
+#define thormang3_demo_FOOTSTEP_PLAN_CACHE_HPP_
+
+/*****************************************************************************
+ ** Includes
+ *****************************************************************************/
+#ifndef Q_MOC_RUN
+
+#include <list>
+#include <map>
+#include <vector>
+#include <geometry_msgs/Pose2D.h>
+
+#endif // Q_MOC_RUN
+
+/*****************************************************************************
+ ** Namespaces
+ *****************************************************************************/
+
+namespace thormang3_demo
+{
+
+/*****************************************************************************
+ ** Class
+ *****************************************************************************/
+
+/**
+ * @brief Least recently used footstep plans by the goal of the planning.
+ *
+ * The goal is quantized to the given resolution, so the goals in the same
+ * cell share a plan. The plans are made on a map, all of them are dropped
+ * when a newer map version is used, and a plan made on an older map version
+ * is not kept.
+ */
+class FootstepPlanCache
+{
+ public:
+  struct Plan
+  {
+    std::vector<geometry_msgs::Pose2D> foot_steps;
+    std::vector<int> foot_types;
+  };
+
+  FootstepPlanCache(int capacity, double position_resolution, double angle_resolution);
+
+  bool find(const geometry_msgs::Pose2D &goal, int map_version, Plan &plan);
+  void insert(const geometry_msgs::Pose2D &goal, int map_version, const Plan &plan);
+  void clear();
+
+ private:
+  struct Key
+  {
+    int x;
+    int y;
+    int theta;
+
+    bool operator<(const Key &other) const;
+  };
+
+  typedef std::list<std::pair<Key, Plan> > PlanList;
+
+  Key makeKey(const geometry_msgs::Pose2D &goal) const;
+  void checkMapVersion(int map_version);
+
+  int capacity_;
+  double position_resolution_;
+  double angle_resolution_;
+  int map_version_;
+
+  PlanList plan_list_;  // most recently used first
+  std::map<Key, PlanList::iterator> plan_table_;
+};
+
+}  // namespace thormang3_demo
+
+#endif /* thormang3_demo_FOOTSTEP_PLAN_CACHE_HPP_ */
@@ -0,0 +1,95 @@
+/*******************************************************************************
+* Copyright 2018 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+/*****************************************************************************
+ ** Ifdefs
+ *****************************************************************************/
+
+#ifndef thormang3_demo_JOINT_INDEX_CACHE_HPP_
+#define thormang3_demo_JOINT_INDEX_CACHE_HPP_
+
+/*****************************************************************************
+ ** Includes
+ *****************************************************************************/
+
+#include <string>
+#include <vector>
+
+#include "name_index_table.hpp"
+
+/*****************************************************************************
+ ** Namespaces
+ *****************************************************************************/
+
+namespace thormang3_demo
+{
+
+/*****************************************************************************
+ ** Class
+ *****************************************************************************/
+
+/**
+ * @brief Index of the joints in the name list of the joint messages.
+ *
+ * Each topic has its own layout of the joint names. The names of a message
+ * are compared with the cached ones once per message, the layout is rebuilt
+ * only when they change, and the cached indexes(also -1 of a missing joint)
+ * are trusted until then.
+ * It is not locked : the joint names and all layouts are set before the
+ * callback threads start, and each layout is used only from the thread of
+ * its topic (e.g. joint states from the sensor thread, the joint modules
+ * from the status thread).
+ */
+class JointIndexCache
+{
+ public:
+  JointIndexCache();
+
+  // the order of the names gives the joint index
+  void setJointNames(const std::vector<std::string> &joint_names);
+  int getJointIndex(const std::string &joint_name) const;  // -1 : unknown joint
+  int getJointSize() const
+  {
+    return joint_name_list_.size();
+  }
+
+  // returns the id of the new layout, called before spinning
+  int addLayout();
+
+  // called once for each message before getMsgIndex()
+  void updateLayout(int layout_id, const std::vector<std::string> &msg_names);
+
+  // index of the joint in the names of the last message, -1 : not in the message
+  int getMsgIndex(int layout_id, int joint_index) const;
+
+ private:
+  struct Layout
+  {
+    bool is_built;
+    std::vector<std::string> msg_name_list;  // names of the message the layout is built for
+    std::vector<int> msg_index_list;         // joint index -> index in the message
+  };
+
+  void buildLayout(Layout &layout, const std::vector<std::string> &msg_names);
+
+  std::vector<std::string> joint_name_list_;
+  NameIndexTable joint_name_table_;
+  std::vector<Layout> layout_list_;
+};
+
+}  // namespace thormang3_demo
+
+#endif /* thormang3_demo_JOINT_INDEX_CACHE_HPP_ */
@@ -0,0 +1,109 @@
+/*******************************************************************************
+* Copyright 2018 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+/*****************************************************************************
+ ** Ifdefs
+ *****************************************************************************/
+
+#ifndef thormang3_demo_JOINT_REGISTRY_HPP_
+#define thormang3_demo_JOINT_REGISTRY_HPP_
+
+/*****************************************************************************
+ ** Includes
+ *****************************************************************************/
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "name_index_table.hpp"
+
+/*****************************************************************************
+ ** Namespaces
+ *****************************************************************************/
+
+namespace thormang3_demo
+{
+
+/*****************************************************************************
+ ** Class
+ *****************************************************************************/
+
+/**
+ * @brief Joints and control modules of the robot in flat tables.
+ *
+ * The joint index is the order of the joint ids and the module index is
+ * the order of the module list of the demo config. The tables are set once
+ * when the config is loaded and only read after it, from any thread.
+ */
+class JointRegistry
+{
+ public:
+  JointRegistry();
+
+  void setJoints(const std::map<int, std::string> &id_joint_table);
+  void setModules(const std::vector<std::string> &module_names);
+
+  // joints
+  int getJointSize() const
+  {
+    return joint_name_list_.size();
+  }
+  const std::vector<std::string> &getJointNames() const
+  {
+    return joint_name_list_;
+  }
+  const std::string &getJointName(int joint_index) const
+  {
+    return joint_name_list_[joint_index];
+  }
+  int getJointID(int joint_index) const
+  {
+    return joint_id_list_[joint_index];
+  }
+  int getJointIndex(const std::string &joint_name) const  // -1 : unknown joint
+  {
+    return joint_name_table_.find(joint_name);
+  }
+  int getJointIndexFromID(int id) const;  // -1 : unknown id
+
+  // modules
+  int getModuleSize() const
+  {
+    return module_name_list_.size();
+  }
+  const std::string &getModuleName(int module_index) const
+  {
+    return module_name_list_[module_index];
+  }
+  int getModuleIndex(const std::string &module_name) const  // -1 : unknown module
+  {
+    return module_name_table_.find(module_name);
+  }
+
+ private:
+  std::vector<std::string> joint_name_list_;  // by joint index
+  std::vector<int> joint_id_list_;            // by joint index
+  std::vector<int> joint_index_list_;         // by joint id, -1 : no joint of the id
+  NameIndexTable joint_name_table_;
+
+  std::vector<std::string> module_name_list_;  // by module index
+  NameIndexTable module_name_table_;
+};
+
+}  // namespace thormang3_demo
+
+#endif /* thormang3_demo_JOINT_REGISTRY_HPP_ */
@@ -0,0 +1,61 @@
+/*******************************************************************************
+* Copyright 2018 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+/*****************************************************************************
+ ** Ifdefs
+ *****************************************************************************/
+
+#ifndef thormang3_demo_JOINT_STATE_BUFFER_HPP_
+#define thormang3_demo_JOINT_STATE_BUFFER_HPP_
+
+/*****************************************************************************
+ ** Includes
+ *****************************************************************************/
+#ifndef Q_MOC_RUN
+
+#include <vector>
+#include <ros/ros.h>
+
+#endif // Q_MOC_RUN
+
+#include "spsc_channel.hpp"
+
+/*****************************************************************************
+ ** Namespaces
+ *****************************************************************************/
+
+namespace thormang3_demo
+{
+
+/*****************************************************************************
+ ** Class
+ *****************************************************************************/
+
+// states of the joints by joint index, NaN : not in the message
+struct JointStateSample
+{
+  ros::Time stamp;
+  std::vector<double> position;
+  std::vector<double> velocity;
+  std::vector<double> effort;
+};
+
+// latest joint state from the sensor callback thread to the gui thread
+typedef SpscLatestValue<JointStateSample> JointStateBuffer;
+
+}  // namespace thormang3_demo
+
+#endif /* thormang3_demo_JOINT_STATE_BUFFER_HPP_ */
@@ -0,0 +1,95 @@
+/*******************************************************************************
+* Copyright 2018 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+/*****************************************************************************
+ ** Ifdefs
+ *****************************************************************************/
+
+#ifndef thormang3_demo_LOG_RING_MODEL_HPP_
+#define thormang3_demo_LOG_RING_MODEL_HPP_
+
+/*****************************************************************************
+ ** Includes
+ *****************************************************************************/
+
+#include <vector>
+#include <QAbstractListModel>
+#include <QMutex>
+#include <QString>
+#include <QTimer>
+
+/*****************************************************************************
+ ** Namespaces
+ *****************************************************************************/
+
+namespace thormang3_demo
+{
+
+/*****************************************************************************
+ ** Class
+ *****************************************************************************/
+
+/**
+ * @brief List model of the latest log lines in a preallocated ring.
+ *
+ * Logs can be appended from any thread, they are moved to the view
+ * by a timer of the gui thread in one batch per flush interval.
+ * The oldest lines are dropped when the ring is full.
+ */
+class LogRingModel : public QAbstractListModel
+{
+Q_OBJECT
+
+ public:
+  LogRingModel(int capacity, int flush_interval_ms = 50, QObject *parent = 0);
+  virtual ~LogRingModel();
+
+  int rowCount(const QModelIndex &parent = QModelIndex()) const;
+  QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+
+  void appendLog(const QString &log);  // thread safe
+  void clear();  // gui thread only
+  int capacity() const
+  {
+    return capacity_;
+  }
+
+Q_SIGNALS:
+  void logFlushed();  // rows are appended to the view
+
+ private Q_SLOTS:
+  void flushPendingLogs();
+
+ private:
+  int capacity_;
+
+  // rows in the view, only accessed in the gui thread
+  std::vector<QString> rows_;
+  int first_row_;
+  int row_count_;
+
+  // logs waiting for the next flush
+  QMutex pending_mutex_;
+  std::vector<QString> pending_logs_;
+  int first_pending_log_;
+  int pending_log_count_;
+
+  QTimer flush_timer_;
+};
+
+}  // namespace thormang3_demo
+
+#endif /* thormang3_demo_LOG_RING_MODEL_HPP_ */
@@ -24,6 +24,8 @@
  *****************************************************************************/
 
 #include <QtGui/QMainWindow>
+#include <QtGui/QTableWidget>
+#include <QTimer>
 #include "ui_main_window.h"
 #include "qnode.hpp"
 
@@ -58,6 +60,10 @@ Q_OBJECT
    ** Auto-connections (connectSlotsByName())
    *******************************************/
   void on_actionAbout_triggered();
+  void on_action_record_commands_toggled(bool checked);
+  void on_action_replay_commands_triggered();
+  void on_action_replay_commands_fast_triggered();
+  void on_action_stop_replay_triggered();
   void on_button_assemble_lidar_clicked(bool check);
   void on_button_clear_log_clicked(bool check);
 
@@ -124,6 +130,7 @@ Q_OBJECT
   void on_button_manipulation_demo_5_clicked(bool check);
   void on_button_manipulation_demo_6_clicked(bool check);
   void on_button_manipulation_demo_7_clicked(bool check);
+  void on_checkBox_ik_streaming_toggled(bool checked);
 
   void on_button_walking_demo_0_clicked(bool check);
   void on_button_walking_demo_1_clicked(bool check);
@@ -146,6 +153,9 @@ Q_OBJECT
   void updatePresentJointModule(std::vector<int> mode);
   void enableModule(QString mode_name);
   void updateHeadJointsAngle(double pan, double tilt);
+  void updateFrame();
+  void abortCommandRecording();
+  void finishCommandReplay();
 
   // Manipulation
   void updateCurrJointSpinbox(double value);
@@ -168,6 +178,7 @@ Q_OBJECT
   static const double GRIPPER_ON_ANGLE = 60;
   static const double GRIPPER_OFF_ANGLE = 5;
   static const double GRIPPER_TORQUE_LIMIT = 250;
+  static const int FRAME_INTERVAL_MS = 50;  // 20 fps, states from the qnode are polled
 
   QString sytlesheet_overload_normal = QString("background-color: rgb(78, 154, 6); color: rgb(46, 52, 54);");
   QString sytlesheet_overload_warning = QString("background-color: rgb(196, 160, 0); color: rgb(85, 87, 83);");
@@ -175,17 +186,22 @@ Q_OBJECT
   QString sytlesheet_overload_none = QString("background-color: rgba(10, 10, 10, 10); color: rgba(0, 0, 0, 0);");
 
   void setUserShortcut();
+  void replayCommands(bool real_time);
   void initModeUnit();
   void initMotionUnit();
+  void initJointStateUnit();
+  void updateJointStateTable();
   void updateModuleUI();
   void setHeadJointsAngle(double pan, double tilt);
   void sendWalkingCommand(const std::string &command);
+  void updateWalkingCommandLatency(const QNodeThor3::WalkingCommandLatency &latency);
   void setGripper(const double angle_deg, const double torque_limit, const std::string &arm_type);
 
   void makeInteractiveMarker();
   void updateInteractiveMarker();
   void clearMarkerPanel();
   void getPoseFromMarkerPanel(geometry_msgs::Pose &current);
+  void getIkTargetFromMarkerPanel(thormang3_manipulation_module_msgs::KinematicsPose &target);
   void setPoseToMarkerPanel(const geometry_msgs::Pose &current);
   void getPointFromMarkerPanel(geometry_msgs::Point &current);
   void setPointToMarkerPanel(const geometry_msgs::Point &current);
@@ -193,26 +209,28 @@ Q_OBJECT
   void clearOverload();
 
   /******************************************
-   ** Transformation
+   ** Transformation : fixed size, see thormang3_foot_step_generator/rotation_math.h
    *******************************************/
-  Eigen::Vector3d rotation2rpy(const Eigen::MatrixXd &rotation);
-  Eigen::MatrixXd rpy2rotation(const double &roll, const double &pitch, const double &yaw);
   Eigen::Quaterniond rpy2quaternion(const Eigen::Vector3d &euler);
   Eigen::Quaterniond rpy2quaternion(const double &roll, const double &pitch, const double &yaw);
-  Eigen::Quaterniond rotation2quaternion(const Eigen::MatrixXd &rotation);
   Eigen::Vector3d quaternion2rpy(const Eigen::Quaterniond &quaternion);
   Eigen::Vector3d quaternion2rpy(const geometry_msgs::Quaternion &quaternion);
-  Eigen::MatrixXd quaternion2rotation(const Eigen::Quaterniond &quaternion);
-  Eigen::MatrixXd rotationX(const double &angle);
-  Eigen::MatrixXd rotationY(const double &angle);
-  Eigen::MatrixXd rotationZ(const double &angle);
 
   Ui::MainWindowDesign ui_;
   QNodeThor3 qnode_thor3_;
   bool debug_print_;
   bool demo_mode_;
   bool is_updating_;
-  std::map<std::string, QList<QWidget *> > module_ui_table_;
+
+  // mode unit, made once in initModeUnit(). only the changed joints and modules are updated
+  std::vector<QComboBox *> joint_module_combo_list_;  // by joint index, NULL : no combo of the joint
+  std::vector<int> shown_joint_modules_;              // by joint index
+  std::vector<QList<QWidget *> > module_widget_list_;  // by module index
+  std::vector<int> shown_module_enabled_;             // by module index, -1 : not shown yet
+
+  // joint states of all joints
+  QTableWidget *joint_state_table_;
+  QTimer frame_timer_;
 };
 
 template<typename T>
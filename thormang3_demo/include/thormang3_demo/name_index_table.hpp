@@ -0,0 +1,77 @@
+/*******************************************************************************
+* Copyright 2018 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+/*****************************************************************************
+ ** Ifdefs
+ *****************************************************************************/
+
+#ifndef thormang3_demo_NAME_INDEX_TABLE_HPP_
+#define thormang3_demo_NAME_INDEX_TABLE_HPP_
+
+/*****************************************************************************
+ ** Includes
+ *****************************************************************************/
+
+#include <string>
+#include <vector>
+
+/*****************************************************************************
+ ** Namespaces
+ *****************************************************************************/
+
+namespace thormang3_demo
+{
+
+/*****************************************************************************
+ ** Class
+ *****************************************************************************/
+
+/**
+ * @brief Index of a name in a fixed list of names, by a perfect hash.
+ *
+ * The seed of the hash is searched when the names are set so that no two
+ * names share a slot. A lookup hashes the name once and compares it with
+ * the one name of its slot, without an allocation or a tree walk.
+ * The names are set once at the start, a lookup is safe from any thread.
+ */
+class NameIndexTable
+{
+ public:
+  NameIndexTable();
+
+  // the order of the names gives the index, a repeated name keeps the first index
+  void setNames(const std::vector<std::string> &names);
+  int find(const std::string &name) const;  // -1 : unknown name
+  int size() const
+  {
+    return name_list_.size();
+  }
+
+ private:
+  static const unsigned int MAX_SEED_TRIAL = 256;  // per slot size, the slots are doubled after it
+
+  static unsigned int hashName(const std::string &name, unsigned int seed);
+  bool buildSlots(unsigned int slot_size, unsigned int seed);
+
+  std::vector<std::string> name_list_;
+  std::vector<int> slot_list_;  // index of the name, -1 : empty
+  unsigned int slot_mask_;
+  unsigned int seed_;
+};
+
+}  // namespace thormang3_demo
+
+#endif /* thormang3_demo_NAME_INDEX_TABLE_HPP_ */
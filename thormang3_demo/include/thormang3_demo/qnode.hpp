@@ -28,12 +28,16 @@
  *****************************************************************************/
 #ifndef Q_MOC_RUN
 
+#include <cstdio>
+#include <ctime>
+#include <limits>
 #include <string>
 #include <sstream>
 #include <QThread>
-#include <QStringListModel>
+#include <QTimer>
 #include <ros/ros.h>
 #include <ros/package.h>
+#include <ros/callback_queue.h>
 #include <std_msgs/Bool.h>
 #include <std_msgs/Int32.h>
 #include <std_msgs/String.h>
@@ -45,11 +49,15 @@
 #include <visualization_msgs/InteractiveMarker.h>
 #include <interactive_markers/interactive_marker_server.h>
 #include <eigen_conversions/eigen_msg.h>
+#include <topic_tools/shape_shifter.h>
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
 #include <boost/thread.hpp>
 #include <yaml-cpp/yaml.h>
 #include <eigen3/Eigen/Eigen>
 
 #include "humanoid_nav_msgs/PlanFootsteps.h"
+#include "humanoid_nav_msgs/PlanFootstepsBetweenFeet.h"
 
 #include "robotis_controller_msgs/JointCtrlModule.h"
 #include "robotis_controller_msgs/GetJointModule.h"
@@ -62,15 +70,27 @@
 #include "thormang3_manipulation_module_msgs/GetJointPose.h"
 #include "thormang3_manipulation_module_msgs/GetKinematicsPose.h"
 
+#include "thormang3_walking_module_msgs/AddStepDataArray.h"
 #include "thormang3_walking_module_msgs/SetBalanceParam.h"
 #include "thormang3_walking_module_msgs/SetJointFeedBackGain.h"
 
 #include "thormang3_foot_step_generator/FootStepCommand.h"
 #include "thormang3_foot_step_generator/Step2DArray.h"
+#include "thormang3_foot_step_generator/CommandLatency.h"
 
 #include "thormang3_alarm_module_msgs/JointOverloadStatus.h"
 
 #endif // Q_MOC_RUN
+
+#include "command_log.hpp"
+#include "footstep_plan_cache.hpp"
+#include "joint_index_cache.hpp"
+#include "joint_registry.hpp"
+#include "joint_state_buffer.hpp"
+#include "log_ring_model.hpp"
+#include "service_request_pool.hpp"
+#include "spsc_channel.hpp"
+
 /*****************************************************************************
  ** Namespaces
  *****************************************************************************/
@@ -102,19 +122,78 @@ Q_OBJECT
     Left = 1,
   };
 
+  typedef boost::function<void()> DemoAction;
+
+  struct HeadJointsAngle
+  {
+    double pan;
+    double tilt;
+  };
+
+  struct OverloadState
+  {
+    int status;
+    int warning_count;
+    int error_count;
+  };
+
+  // stages of a walking command in ms, NaN : not known
+  struct WalkingCommandLatency
+  {
+    int command_id;
+    std::string command;
+    int result;             // of add_step_data in the walking module
+    double sent;            // to the foot step generator
+    double ref_step;        // reference step is fetched from the walking module
+    double generation;      // steps are generated
+    double acceptance;      // walking module accepted the steps
+    double total;           // from the gui to the acceptance
+    double walking_start;   // from the gui to the start of the walking
+  };
+
   QNodeThor3(int argc, char** argv);
   virtual ~QNodeThor3();
 
   bool init();
   void run();
-  QStringListModel* loggingModel()
+  LogRingModel* loggingModel()
   {
     return &logging_model_;
   }
+
+  // gui thread, polled on the frame timer. false(NULL) if nothing new
+  const JointStateSample* takeJointStateSample()
+  {
+    return joint_state_buffer_.takeLatest();
+  }
+  bool takeHeadJointsAngle(HeadJointsAngle& angle)
+  {
+    return head_joints_angle_channel_.takeLatest(angle);
+  }
+  bool takeCurrPose(geometry_msgs::Pose& pose)
+  {
+    return curr_pose_channel_.takeLatest(pose);
+  }
+  bool takeMarkerPose(geometry_msgs::Pose& pose)
+  {
+    return marker_pose_channel_.takeLatest(pose);
+  }
+  bool takeOverloadState(int side, OverloadState& state)
+  {
+    return overload_state_channel_[side].takeLatest(state);
+  }
+  bool takeDemoPoint(geometry_msgs::Point& point)
+  {
+    return demo_point_channel_.pop(point);
+  }
+  bool takeWalkingCommandLatency(WalkingCommandLatency& latency);
   void log(const LogLevel& level, const std::string& msg, std::string sender = "Demo");
   void clearLog();
   void assembleLidar();
   void enableControlModule(const std::string& mode);
+  void enableControlModule(const std::string& mode, const DemoAction& action_after_enabled);
+  void enableControlModules(const std::vector<std::string>& modes, const DemoAction& action_after_enabled = DemoAction());
+  void setJointControlModules(const std::vector<int>& joint_modules, const DemoAction& action_after_set = DemoAction());
   bool getJointNameFromID(const int& id, std::string& joint_name);
   bool getIDFromJointName(const std::string& joint_name, int& id);
   bool getIDJointNameFromIndex(const int& index, int& id, std::string& joint_name);
@@ -134,6 +213,13 @@ Q_OBJECT
   void sendInitPoseMsg(std_msgs::String msg);
   void sendDestJointMsg(thormang3_manipulation_module_msgs::JointPose msg);
   void sendIkMsg(thormang3_manipulation_module_msgs::KinematicsPose msg);
+  void startIkStreaming();
+  void stopIkStreaming();
+  void setIkStreamingTarget(const thormang3_manipulation_module_msgs::KinematicsPose& target);
+  bool isIkStreaming()
+  {
+    return is_ik_streaming_;
+  }
   void sendGripperPosition(sensor_msgs::JointState msg);
 
   // Walking
@@ -157,12 +243,31 @@ Q_OBJECT
   void updateInteractiveMarker(const geometry_msgs::Pose& pose);
   void getInteractiveMarkerPose();
   void clearInteractiveMarker();
+  void flushInteractiveMarker();
   void manipulationDemo(const int& index);
   void kickDemo(const std::string& kick_foot);
+  bool isKickDemoRunning()
+  {
+    return kick_demo_state_ != KickDemoIdle;
+  }
 
   // overload - alarm
   void publishAlarmCommand(const std::string &command);
 
+  // command log : the published commands are recorded to a file and replayed at 1x or at once
+  bool startRecordingCommands(const std::string& path);
+  void stopRecordingCommands();
+  bool isRecordingCommands()
+  {
+    return command_log_writer_.isOpen();
+  }
+  bool replayCommands(const std::string& path, bool real_time);
+  void stopReplayingCommands();
+  bool isReplayingCommands()
+  {
+    return is_replaying_commands_;
+  }
+
   std::map<int, std::string> module_table_;
   std::map<int, std::string> motion_table_;
 
@@ -175,6 +280,15 @@ Q_OBJECT
   void getKinematicsPoseCallback(const geometry_msgs::Pose::ConstPtr& msg);
   void setCurrentControlUI(int mode);
 
+ private Q_SLOTS:
+  void serviceRequestFinished(int request_id, QString name, int result);
+  void updatePresentJointModules();
+  void runModuleActions();
+  void walkingFinished();
+  void kickDemoTimeout();
+  void streamIkTarget();
+  void replayNextCommand();
+
 Q_SIGNALS:
   void loggingUpdated();
   void rosShutdown();
@@ -185,15 +299,16 @@ Q_SIGNALS:
   void updateCurrPos(double x, double y, double z);
   void updateCurrOri(double x, double y, double z, double w);
 
-  // Head control
-  void updateHeadJointsAngle(double pan, double tilt);
-
   // Interactive marker
-  void updateDemoPoint(const geometry_msgs::Point point);
   void updateDemoPose(const geometry_msgs::Pose pose);
 
-  // Overload
-  void updateOverloadStatus(int side, int overload_status, int warning_count, int error_count);
+  // from ros callbacks to the gui thread
+  void controlModuleUpdated();
+  void walkingStatusFinished();
+
+  // command log
+  void commandRecordingAborted();
+  void commandReplayFinished();
 
  private:
   enum Control_Index
@@ -206,26 +321,147 @@ Q_SIGNALS:
     DEMO_UI = 5,
   };
 
+  enum KickDemoState
+  {
+    KickDemoIdle = 0,
+    KickDemoKicking = 1,     // waiting for the walking module to finish the kick
+    KickDemoRecovering = 2,  // restored balance param is being applied
+  };
+
+  struct ModuleAction
+  {
+    std::vector<std::string> module_name_list;  // each module is set to any joint
+    std::vector<int> joint_module_list;         // module index by joint index, -1 : any module
+    DemoAction action;
+    ros::WallTime deadline;
+  };
+
   static const double DEGREE2RADIAN = M_PI / 180.0;
   static const double RADIAN2DEGREE = 180.0 / M_PI;
+  static const int LOG_CAPACITY = 2000;  // lines kept in the log view
+  static const int SERVICE_THREAD_NUM = 3;  // the planners take two of them while planning
+  static const double SERVICE_TIMEOUT = 3.0;           // sec
+  static const double FOOTSTEP_PLANNER_TIMEOUT = 10.0;  // sec, planner takes up to its allocated time(4 sec)
+  static const double MODULE_SWITCH_TIMEOUT = 1.0;      // sec
+  static const int MODULE_ACTION_CHECK_INTERVAL_MS = 50;
+  static const int KICK_TIMEOUT_MS = 10000;              // when the walking module does not report the end
+  static const double JOINT_STATE_SAMPLE_PERIOD = 0.02;  // sec
+  static const int DEMO_POINT_CHANNEL_SIZE = 16;
+  static const double BALANCE_UPDATING_DURATION = 2.0;  // sec
+  static const int FOOTSTEP_PLAN_CACHE_SIZE = 16;
+  static const double FOOTSTEP_PLAN_CACHE_POSITION_RESOLUTION = 0.02;           // m, cell size of the planner
+  static const double FOOTSTEP_PLAN_CACHE_ANGLE_RESOLUTION = 2 * M_PI / 128;  // rad, angle bin of the planner
+  static const double IK_STREAMING_RATE = 10.0;                  // Hz
+  static const double IK_STREAMING_POSITION_DEADBAND = 0.005;    // m
+  static const double IK_STREAMING_ANGLE_DEADBAND = M_PI / 180;  // rad
+  static const double IK_STREAMING_LINEAR_SPEED = 0.1;           // m/s
+  static const double IK_STREAMING_ANGULAR_SPEED = M_PI / 6;     // rad/s
+
+  typedef boost::function<bool(CommandLogReader::Record&)> ReplayFunction;
+
+  // every command to the robot is published through this to be recorded
+  template<class Message>
+  void publishCommand(ros::Publisher& pub, const Message& msg)
+  {
+    pub.publish(msg);
+
+    if (command_log_writer_.isOpen() == true && command_log_writer_.write(pub.getTopic(), msg) == false)
+      abortRecordingCommands();
+  }
+
+  template<class Message>
+  void addReplayPublisher(const ros::Publisher& pub)
+  {
+    replay_function_table_[pub.getTopic()] = boost::bind(&QNodeThor3::replayMessage<Message>, pub, _1);
+  }
+
+  template<class Message>
+  static bool replayMessage(ros::Publisher pub, CommandLogReader::Record& record)
+  {
+    // message definition is changed after the recording
+    if (record.md5sum != ros::message_traits::md5sum<Message>())
+      return false;
+
+    Message msg;
+    if (record.data.empty() == false)
+    {
+      // a broken record is skipped
+      try
+      {
+        ros::serialization::IStream stream(&record.data[0], record.data.size());
+        ros::serialization::deserialize(stream, msg);
+      }
+      catch (const ros::serialization::StreamOverrunException& e)
+      {
+        return false;
+      }
+    }
+
+    restampCommand(msg);
+    pub.publish(msg);
+    return true;
+  }
+
+  // a replayed walking command is timed from the replay
+  template<class Message>
+  static void restampCommand(Message& msg)
+  {
+  }
+  static void restampCommand(thormang3_foot_step_generator::FootStepCommand& msg)
+  {
+    msg.stamp = ros::Time::now();
+  }
+  static void restampCommand(thormang3_foot_step_generator::Step2DArray& msg)
+  {
+    msg.stamp = ros::Time::now();
+  }
+
+  void abortRecordingCommands();
+  void scheduleNextCommand();
+  void finishReplayingCommands();
 
   void parseJointNameFromYaml(const std::string& path);
   void parseMotionMapFromYaml(const std::string& path);
   void refreshCurrentJointControlCallback(const robotis_controller_msgs::JointCtrlModule::ConstPtr& msg);
   void
   updateHeadJointStatesCallback(const sensor_msgs::JointState::ConstPtr& msg);
+  void updateJointStateBuffer(const sensor_msgs::JointState::ConstPtr& msg);
   void initFTFootCallback(const thormang3_feet_ft_module_msgs::BothWrench::ConstPtr& msg);
   void
   statusMsgCallback(const robotis_controller_msgs::StatusMsg::ConstPtr& msg);
   void poseCallback(const geometry_msgs::Pose::ConstPtr& msg);
   void interactiveMarkerFeedback(const visualization_msgs::InteractiveMarkerFeedbackConstPtr& feedback);
   void pointStampedCallback(const geometry_msgs::PointStamped::ConstPtr& msg);
+  void mapCallback(const topic_tools::ShapeShifter::ConstPtr& msg);
+  void applyJointControlModule(boost::shared_ptr<robotis_controller_msgs::GetJointModule> get_joint);
+  void applyPresentJointModules(const std::vector<int>& joint_modules);
+  void addModuleAction(const ModuleAction& module_action);
+  bool isModuleActionReady(const ModuleAction& module_action);
+  void applyJointPose(boost::shared_ptr<thormang3_manipulation_module_msgs::GetJointPose> get_joint_pose);
+  void applyKinematicsPose(
+      boost::shared_ptr<thormang3_manipulation_module_msgs::GetKinematicsPose> get_kinematics_pose);
+  void applyFootstepsFromPlanner(boost::shared_ptr<humanoid_nav_msgs::PlanFootsteps> get_step, int map_version,
+                                 bool is_final_plan);
+  void makeFootstepMarkers(std::vector<visualization_msgs::Marker>& footstep_markers);
+  thormang3_foot_step_generator::Step2DArray makeStep2DArray(const std::vector<geometry_msgs::Pose2D>& foot_steps,
+                                                             const std::vector<int>& foot_types, int begin_index,
+                                                             int end_index);
+  void planRestFootsteps(int horizon);
+  void applyRestFootsteps(boost::shared_ptr<humanoid_nav_msgs::PlanFootstepsBetweenFeet> get_step);
+  void appendRestFootsteps(const std::vector<geometry_msgs::Pose2D>& foot_steps, const std::vector<int>& foot_types);
+  void walkRestFootstepsFromStance(const std::vector<geometry_msgs::Pose2D>& foot_steps,
+                                   const std::vector<int>& foot_types);
+  void applyBalanceParameter(boost::shared_ptr<thormang3_walking_module_msgs::SetBalanceParam> set_balance_param);
+  void applyFeedBackGain(boost::shared_ptr<thormang3_walking_module_msgs::SetJointFeedBackGain> set_feedback_gain);
   void setBalanceParameter();
+  bool setBalanceParameterPreset(const std::string& preset_name);
   bool loadBalanceParameterFromYaml();
+  void makeBalanceParamPresets(const thormang3_walking_module_msgs::BalanceParam& balance_param);
   void turnOnBalance();
   void turnOffBalance();
   bool loadFeedbackGainFromYaml();
   void overloadStatusCallback(const thormang3_alarm_module_msgs::JointOverloadStatus::ConstPtr &msg);
+  void commandLatencyCallback(const thormang3_foot_step_generator::CommandLatency::ConstPtr &msg);
 
   int init_argc_;
   char** init_argv_;
@@ -239,7 +475,15 @@ Q_SIGNALS:
   std::string frame_id_;
   std::string marker_name_;
   geometry_msgs::Pose pose_from_ui_;
-  geometry_msgs::Pose current_pose_;
+
+  // marker changes are applied once a frame by flushInteractiveMarker(), only the latest pose of each side is kept
+  SpscLatestValue<geometry_msgs::Pose> marker_pose_channel_;  // dragged in rviz, to the gui
+  boost::atomic<bool> is_marker_dragged_;                      // the server has a pose to send to the clients
+  bool is_marker_shown_;
+  bool is_marker_pose_pending_;         // set from the gui, not applied yet
+  geometry_msgs::Pose pending_marker_pose_;
+  bool is_applied_marker_pose_valid_;   // false after a drag, the server pose is not the applied one
+  geometry_msgs::Pose applied_marker_pose_;
   boost::shared_ptr<interactive_markers::InteractiveMarkerServer> interactive_marker_server_;
   thormang3_walking_module_msgs::SetBalanceParam set_balance_param_srv_;
   thormang3_walking_module_msgs::SetJointFeedBackGain set_joint_feedback_gain_srv_;
@@ -272,32 +516,128 @@ Q_SIGNALS:
 
   ros::Publisher send_gripper_pub_;
 
+  // ik targets streamed at a fixed rate : a sent target moves toward the latest one from the operator
+  // by the speed limits, a move inside the deadband is not sent. gui thread only
+  QTimer ik_streaming_timer_;
+  bool is_ik_streaming_;
+  bool has_ik_streaming_target_;
+  bool has_sent_ik_streaming_pose_;
+  thormang3_manipulation_module_msgs::KinematicsPose ik_streaming_target_;
+  geometry_msgs::Pose sent_ik_streaming_pose_;
+  double ik_streaming_rate_;                // Hz
+  double ik_streaming_position_deadband_;   // m
+  double ik_streaming_angle_deadband_;      // rad
+  double ik_streaming_linear_speed_;        // m/s
+  double ik_streaming_angular_speed_;       // rad/s
+
   // Walking
   ros::ServiceClient humanoid_footstep_client_;
+  ros::ServiceClient humanoid_first_footstep_client_;  // planner stopping at the first solution
+  bool use_first_footstep_planner_;
   ros::ServiceClient set_balance_param_client_;
   ros::ServiceClient set_joint_feedback_gain_client_;
   ros::Publisher set_walking_command_pub_;
   ros::Publisher set_walking_footsteps_pub_;
+  ros::Publisher append_walking_footsteps_pub_;
   ros::Publisher set_walking_balance_pub_;
 
+  // latency of the walking commands, reported by the foot step generator with the id of a command
+  ros::Subscriber command_latency_sub_;
+  SpscLatestValue<thormang3_foot_step_generator::CommandLatency> command_latency_channel_;
+  SpscLatestValue<ros::Time> walking_started_channel_;
+  unsigned int last_walking_command_id_;        // gui thread
+  WalkingCommandLatency walking_command_latency_;  // last reported, gui thread
+  ros::Time walking_command_published_;
+  ros::Time walking_started_time_;
+  bool is_walking_start_pending_;               // the accepted steps are started automatically
+
   std::vector<geometry_msgs::Pose2D> preview_foot_steps_;
   std::vector<int> preview_foot_types_;
+  std::vector<visualization_msgs::Marker> shown_footstep_markers_;  // published markers, index of the step
+
+  // plans by the goal, dropped when the map of the planner is updated
+  ros::Subscriber map_sub_;
+  boost::atomic<int> map_version_;
+  FootstepPlanCache footstep_plan_cache_;
+
+  // receding horizon walking : the first steps of a plan are walked while the rest is planned again
+  // from the stance after them, 0 : the whole plan is walked at once
+  int footstep_execution_horizon_;
+  ros::ServiceClient humanoid_footstep_feet_client_;
+  bool is_rest_footsteps_pending_;
+  bool is_walking_finished_before_rest_;  // the rest is walked as new footsteps from the stance
+  std::vector<geometry_msgs::Pose2D> walked_foot_steps_;  // first steps of the walked plan, sent again with the rest
+  std::vector<int> walked_foot_types_;
+  std::vector<geometry_msgs::Pose2D> rest_foot_steps_;  // of the walked plan, used when the planning fails
+  std::vector<int> rest_foot_types_;
 
   // Action
   ros::Publisher motion_index_pub_;
   ros::Publisher motion_page_pub_;
 
+  ros::CallbackQueue sensor_callback_queue_;  // joint states, ft, overload, poses
+  ros::CallbackQueue status_callback_queue_;  // status messages, control modules, clicked point
+
   ros::Time start_time_;
-  QStringListModel logging_model_;
-  std::map<int, std::string> id_joint_table_;
-  std::map<std::string, int> joint_id_table_;
-  std::map<int, std::string> index_mode_table_;
-  std::map<std::string, int> mode_index_table_;
-  std::map<std::string, bool> using_mode_table_;
+  LogRingModel logging_model_;
+  ServiceRequestPool service_request_pool_;  // blocking service calls from the gui
+
+  // parameter sets parsed from the yaml files, parsed again only when a file is modified
+  std::map<std::string, thormang3_walking_module_msgs::BalanceParam> balance_param_preset_table_;
+  time_t balance_yaml_modified_time_;
+  time_t joint_feedback_yaml_modified_time_;
+
+  // last sent to the walking module, an unchanged set is not sent again
+  thormang3_walking_module_msgs::BalanceParam sent_balance_param_;
+  thormang3_walking_module_msgs::JointFeedBackGain sent_joint_feedback_gain_;
+  bool is_balance_param_sent_;
+  bool is_joint_feedback_gain_sent_;
+
+  // joints and modules of the demo config, set once at init
+  JointRegistry joint_registry_;
+  std::vector<bool> using_module_list_;               // by module index, gui thread
+  std::vector<std::vector<int> > module_joint_list_;  // joint indexes set by a module switch, by module index
+  std::vector<int> present_joint_modules_;           // module index by joint index, gui thread
+
+  // joints in the messages of the sensor callbacks
+  JointIndexCache joint_index_cache_;
+  int joint_state_layout_;
+  int overload_status_layout_;
+  int joint_module_layout_;
+  int head_pan_joint_index_;
+  int head_tilt_joint_index_;
+  int right_knee_joint_index_;
+  int left_knee_joint_index_;
+  JointStateBuffer joint_state_buffer_;
+  ros::WallTime last_joint_state_sample_time_;
+
+  // from the ros callbacks to the gui, without a signal per message
+  SpscLatestValue<HeadJointsAngle> head_joints_angle_channel_;
+  SpscLatestValue<geometry_msgs::Pose> curr_pose_channel_;
+  SpscLatestValue<OverloadState> overload_state_channel_[2];  // Side
+  SpscRing<geometry_msgs::Point> demo_point_channel_;        // every clicked point
+  SpscLatestValue<std::vector<int> > present_joint_module_channel_;  // module index by joint index, -1 : unknown
 
   // Overload - Alarm
   ros::Publisher overload_com_pub_;
   ros::Subscriber overload_status_sub_;
+
+  // command log, gui thread only. replayed commands are not recorded again
+  CommandLogWriter command_log_writer_;
+  CommandLogReader command_log_reader_;
+  std::map<std::string, ReplayFunction> replay_function_table_;  // by topic
+  QTimer command_replay_timer_;
+  bool is_replaying_commands_;
+  bool is_real_time_replay_;
+  CommandLogReader::Record next_command_record_;
+  ros::WallTime command_replay_start_time_;  // of the log time 0
+  int replayed_command_count_;
+
+  // demo sequence, gui thread only
+  std::vector<ModuleAction> module_action_list_;
+  QTimer module_action_timer_;
+  KickDemoState kick_demo_state_;
+  QTimer kick_demo_timer_;
 };
 
 }  // namespace thormang3_demo
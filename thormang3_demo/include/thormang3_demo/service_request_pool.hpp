@@ -0,0 +1,145 @@
+/*******************************************************************************
+* Copyright 2018 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+/*****************************************************************************
+ ** Ifdefs
+ *****************************************************************************/
+
+#ifndef thormang3_demo_SERVICE_REQUEST_POOL_HPP_
+#define thormang3_demo_SERVICE_REQUEST_POOL_HPP_
+
+/*****************************************************************************
+ ** Includes
+ *****************************************************************************/
+#ifndef Q_MOC_RUN
+
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <ros/ros.h>
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+#endif // Q_MOC_RUN
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+/*****************************************************************************
+ ** Namespaces
+ *****************************************************************************/
+
+namespace thormang3_demo
+{
+
+/*****************************************************************************
+ ** Class
+ *****************************************************************************/
+
+/**
+ * @brief Runs blocking service calls on worker threads for the gui thread.
+ *
+ * The call of a request runs on a worker thread, the apply function runs
+ * on the gui thread after the call succeeded, and requestFinished() is
+ * emitted for every request.
+ * Requests with the same name are called in order, one at a time.
+ * A request that is canceled or timed out is finished at once, the late
+ * response of its call is dropped.
+ */
+class ServiceRequestPool : public QObject
+{
+Q_OBJECT
+
+ public:
+  enum RequestResult
+  {
+    Succeeded = 0,
+    Failed = 1,    // service is not available or the call failed
+    TimedOut = 2,
+    Canceled = 3
+  };
+
+  typedef boost::function<bool()> CallFunction;   // worker thread, true if the service responded
+  typedef boost::function<void()> ApplyFunction;  // gui thread
+
+  ServiceRequestPool(int thread_num, QObject *parent = 0);
+  virtual ~ServiceRequestPool();
+
+  // returns the id of the request
+  int request(const std::string &name, double timeout_sec, const CallFunction &call, const ApplyFunction &apply);
+
+  template<class Service>
+  int requestService(const std::string &name, double timeout_sec, const ros::ServiceClient &client,
+                     const boost::shared_ptr<Service> &srv, const ApplyFunction &apply)
+  {
+    return request(name, timeout_sec, boost::bind(&ServiceRequestPool::callService<Service>, client, srv), apply);
+  }
+
+  // gui thread only
+  void cancel(int request_id);
+  void cancel(const std::string &name);
+  bool isRequested(const std::string &name);
+
+Q_SIGNALS:
+  void requestFinished(int request_id, QString name, int result);
+
+ private Q_SLOTS:
+  void finishRequest(int request_id);
+  void checkTimeout();
+
+ private:
+  struct Request
+  {
+    std::string name;
+    ros::WallTime deadline;
+    CallFunction call;
+    ApplyFunction apply;
+    bool called;
+    bool call_result;
+  };
+
+  static const int TIMEOUT_CHECK_INTERVAL_MS = 100;
+
+  template<class Service>
+  static bool callService(ros::ServiceClient client, boost::shared_ptr<Service> srv)
+  {
+    return client.call(*srv);
+  }
+
+  void processRequests();
+  bool takeRequest(int &request_id, std::string &name, CallFunction &call);
+  void removeRequest(int request_id, RequestResult result);
+
+  boost::mutex request_mutex_;
+  boost::condition_variable request_cond_;
+  std::map<int, Request> request_table_;
+  std::deque<int> waiting_request_list_;
+  std::set<std::string> running_name_set_;
+  int last_request_id_;
+  bool stop_;
+
+  boost::thread_group worker_threads_;
+  QTimer timeout_timer_;
+};
+
+}  // namespace thormang3_demo
+
+#endif /* thormang3_demo_SERVICE_REQUEST_POOL_HPP_ */
@@ -0,0 +1,187 @@
+/*******************************************************************************
+* Copyright 2018 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+/*****************************************************************************
+ ** Ifdefs
+ *****************************************************************************/
+
+#ifndef thormang3_demo_SPSC_CHANNEL_HPP_
+#define thormang3_demo_SPSC_CHANNEL_HPP_
+
+/*****************************************************************************
+ ** Includes
+ *****************************************************************************/
+#ifndef Q_MOC_RUN
+
+#include <cstddef>
+#include <vector>
+#include <boost/atomic.hpp>
+
+#endif // Q_MOC_RUN
+
+/*****************************************************************************
+ ** Namespaces
+ *****************************************************************************/
+
+namespace thormang3_demo
+{
+
+/*****************************************************************************
+ ** Class
+ *****************************************************************************/
+
+/**
+ * @brief Bounded queue from one producer thread to one consumer thread without a lock.
+ *
+ * The slots are allocated at the construction and the values are copied
+ * into them, so a value type which keeps its capacity(ex. a vector of the
+ * same size) is passed without allocation. A value pushed to a full queue
+ * is dropped and counted.
+ */
+template<typename T>
+class SpscRing
+{
+ public:
+  explicit SpscRing(int capacity)
+      : slot_list_(capacity + 1),
+        head_(0),
+        tail_(0),
+        dropped_count_(0)
+  {
+  }
+
+  // producer
+  bool push(const T &value)
+  {
+    int tail = tail_.load(boost::memory_order_relaxed);
+    int next_tail = (tail + 1) % slot_list_.size();
+
+    if (next_tail == head_.load(boost::memory_order_acquire))
+    {
+      dropped_count_.fetch_add(1, boost::memory_order_relaxed);
+      return false;
+    }
+
+    slot_list_[tail] = value;
+    tail_.store(next_tail, boost::memory_order_release);
+    return true;
+  }
+
+  // consumer
+  bool pop(T &value)
+  {
+    int head = head_.load(boost::memory_order_relaxed);
+    if (head == tail_.load(boost::memory_order_acquire))
+      return false;
+
+    value = slot_list_[head];
+    head_.store((head + 1) % slot_list_.size(), boost::memory_order_release);
+    return true;
+  }
+
+  int droppedCount() const
+  {
+    return dropped_count_.load(boost::memory_order_relaxed);
+  }
+
+ private:
+  std::vector<T> slot_list_;  // one slot is kept empty to tell full from empty
+  boost::atomic<int> head_;   // next slot to pop
+  boost::atomic<int> tail_;   // next slot to push
+  boost::atomic<int> dropped_count_;
+};
+
+/**
+ * @brief Latest value from one producer thread to one consumer thread without a lock.
+ *
+ * The latest value wins, the consumer gets only the last published one.
+ * A ring can not overwrite the unread values without a lock, so three
+ * slots are used : the producer writes one, the consumer reads one and the
+ * third is swapped between them. Neither side waits and a value is never
+ * read while it is written.
+ */
+template<typename T>
+class SpscLatestValue
+{
+ public:
+  SpscLatestValue()
+      : write_index_(0),
+        read_index_(1),
+        shared_index_(2)
+  {
+  }
+
+  // before the producer and the consumer start
+  void reset(const T &value)
+  {
+    for (int ix = 0; ix < 3; ix++)
+      slot_list_[ix] = value;
+  }
+
+  // producer : fill the write value and publish it
+  T &getWriteValue()
+  {
+    return slot_list_[write_index_];
+  }
+
+  void publish()
+  {
+    int prev_index = shared_index_.exchange(write_index_ | NEW_VALUE_FLAG, boost::memory_order_acq_rel);
+    write_index_ = prev_index & INDEX_MASK;
+  }
+
+  void push(const T &value)
+  {
+    getWriteValue() = value;
+    publish();
+  }
+
+  // consumer : NULL if nothing is published since the last one.
+  // the value is valid until the next call
+  const T *takeLatest()
+  {
+    if ((shared_index_.load(boost::memory_order_relaxed) & NEW_VALUE_FLAG) == 0)
+      return NULL;
+
+    int prev_index = shared_index_.exchange(read_index_, boost::memory_order_acq_rel);
+    read_index_ = prev_index & INDEX_MASK;
+
+    return &slot_list_[read_index_];
+  }
+
+  bool takeLatest(T &value)
+  {
+    const T *latest_value = takeLatest();
+    if (latest_value == NULL)
+      return false;
+
+    value = *latest_value;
+    return true;
+  }
+
+ private:
+  static const int NEW_VALUE_FLAG = 0x4;
+  static const int INDEX_MASK = 0x3;
+
+  T slot_list_[3];
+  int write_index_;                  // producer only
+  int read_index_;                   // consumer only
+  boost::atomic<int> shared_index_;  // index of the swapped slot | NEW_VALUE_FLAG
+};
+
+}  // namespace thormang3_demo
+
+#endif /* thormang3_demo_SPSC_CHANNEL_HPP_ */
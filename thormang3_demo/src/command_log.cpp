@@ -0,0 +1,241 @@
+/*******************************************************************************
+* Copyright 2018 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+/*****************************************************************************
+ ** Includes
+ *****************************************************************************/
+
+#include <algorithm>
+
+#include "../include/thormang3_demo/command_log.hpp"
+
+/*****************************************************************************
+ ** Namespaces
+ *****************************************************************************/
+
+namespace thormang3_demo
+{
+
+/*****************************************************************************
+ ** Constants
+ *****************************************************************************/
+
+static const char COMMAND_LOG_MAGIC[8] = { 'T', '3', 'C', 'M', 'D', 'L', 'O', 'G' };
+static const uint32_t COMMAND_LOG_VERSION = 1;
+static const uint8_t TOPIC_RECORD = 0;
+static const uint8_t MESSAGE_RECORD = 1;
+
+/*****************************************************************************
+ ** Implementation [Writer]
+ *****************************************************************************/
+
+CommandLogWriter::CommandLogWriter()
+{
+}
+
+CommandLogWriter::~CommandLogWriter()
+{
+  close();
+}
+
+bool CommandLogWriter::open(const std::string &path)
+{
+  close();
+
+  file_.open(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (file_.is_open() == false)
+    return false;
+
+  file_.write(COMMAND_LOG_MAGIC, sizeof(COMMAND_LOG_MAGIC));
+  file_.write(reinterpret_cast<const char*>(&COMMAND_LOG_VERSION), sizeof(COMMAND_LOG_VERSION));
+
+  start_time_ = ros::WallTime::now();
+  topic_id_table_.clear();
+
+  return file_.good();
+}
+
+void CommandLogWriter::close()
+{
+  if (file_.is_open() == true)
+    file_.close();
+}
+
+bool CommandLogWriter::writeMessage(const std::string &topic, const std::string &datatype, const std::string &md5sum,
+                                    const std::vector<uint8_t> &data)
+{
+  if (file_.is_open() == false)
+    return false;
+
+  std::map<std::string, uint16_t>::iterator topic_it = topic_id_table_.find(topic);
+  if (topic_it == topic_id_table_.end())
+  {
+    uint16_t topic_id = topic_id_table_.size();
+    topic_it = topic_id_table_.insert(std::make_pair(topic, topic_id)).first;
+
+    file_.write(reinterpret_cast<const char*>(&TOPIC_RECORD), sizeof(TOPIC_RECORD));
+    file_.write(reinterpret_cast<const char*>(&topic_id), sizeof(topic_id));
+    writeString(topic);
+    writeString(datatype);
+    writeString(md5sum);
+  }
+
+  int64_t time_ns = (ros::WallTime::now() - start_time_).toNSec();
+  uint32_t size = data.size();
+
+  file_.write(reinterpret_cast<const char*>(&MESSAGE_RECORD), sizeof(MESSAGE_RECORD));
+  file_.write(reinterpret_cast<const char*>(&topic_it->second), sizeof(topic_it->second));
+  file_.write(reinterpret_cast<const char*>(&time_ns), sizeof(time_ns));
+  file_.write(reinterpret_cast<const char*>(&size), sizeof(size));
+  if (size > 0)
+    file_.write(reinterpret_cast<const char*>(&data[0]), size);
+
+  // a write error(e.g. the disk is full) shows up when the buffer is written
+  file_.flush();
+  return file_.good();
+}
+
+void CommandLogWriter::writeString(const std::string &value)
+{
+  uint32_t size = value.size();
+
+  file_.write(reinterpret_cast<const char*>(&size), sizeof(size));
+  file_.write(value.data(), size);
+}
+
+/*****************************************************************************
+ ** Implementation [Reader]
+ *****************************************************************************/
+
+CommandLogReader::CommandLogReader()
+    : file_size_(0)
+{
+}
+
+bool CommandLogReader::open(const std::string &path)
+{
+  close();
+
+  file_.open(path.c_str(), std::ios::in | std::ios::binary);
+  if (file_.is_open() == false)
+    return false;
+
+  // the sizes in the records are checked with the length of the file
+  file_.seekg(0, std::ios::end);
+  file_size_ = file_.tellg();
+  file_.seekg(0, std::ios::beg);
+
+  char magic[sizeof(COMMAND_LOG_MAGIC)];
+  uint32_t version = 0;
+
+  file_.read(magic, sizeof(magic));
+  file_.read(reinterpret_cast<char*>(&version), sizeof(version));
+
+  if (file_.good() == false || std::equal(magic, magic + sizeof(magic), COMMAND_LOG_MAGIC) == false
+      || version != COMMAND_LOG_VERSION)
+  {
+    close();
+    return false;
+  }
+
+  topic_list_.clear();
+  return true;
+}
+
+void CommandLogReader::close()
+{
+  if (file_.is_open() == true)
+    file_.close();
+  file_.clear();
+}
+
+bool CommandLogReader::readNext(Record &record)
+{
+  if (file_.is_open() == false)
+    return false;
+
+  while (true)
+  {
+    uint8_t record_type;
+    uint16_t topic_id;
+
+    file_.read(reinterpret_cast<char*>(&record_type), sizeof(record_type));
+    file_.read(reinterpret_cast<char*>(&topic_id), sizeof(topic_id));
+    if (file_.good() == false)
+      return false;
+
+    if (record_type == TOPIC_RECORD)
+    {
+      if (topic_id >= topic_list_.size())
+        topic_list_.resize(topic_id + 1);
+
+      Topic &topic = topic_list_[topic_id];
+      if (readString(topic.name) == false || readString(topic.datatype) == false || readString(topic.md5sum) == false)
+        return false;
+
+      continue;
+    }
+
+    if (record_type != MESSAGE_RECORD || topic_id >= topic_list_.size())
+      return false;
+
+    int64_t time_ns;
+    uint32_t size;
+
+    file_.read(reinterpret_cast<char*>(&time_ns), sizeof(time_ns));
+    file_.read(reinterpret_cast<char*>(&size), sizeof(size));
+    if (file_.good() == false || isReadable(size) == false)
+      return false;
+
+    record.data.resize(size);
+    if (size > 0)
+      file_.read(reinterpret_cast<char*>(&record.data[0]), size);
+    if (file_.good() == false)
+      return false;
+
+    const Topic &topic = topic_list_[topic_id];
+    record.topic = topic.name;
+    record.datatype = topic.datatype;
+    record.md5sum = topic.md5sum;
+    record.time = time_ns * 1e-9;
+
+    return true;
+  }
+}
+
+bool CommandLogReader::readString(std::string &value)
+{
+  uint32_t size = 0;
+
+  file_.read(reinterpret_cast<char*>(&size), sizeof(size));
+  if (file_.good() == false || isReadable(size) == false)
+    return false;
+
+  value.resize(size);
+  if (size > 0)
+    file_.read(&value[0], size);
+
+  return file_.good();
+}
+
+// a broken size is not allocated
+bool CommandLogReader::isReadable(uint32_t size)
+{
+  std::streamoff position = file_.tellg();
+  return position >= 0 && static_cast<std::streamoff>(size) <= file_size_ - position;
+}
+
+}  // namespace thormang3_demo
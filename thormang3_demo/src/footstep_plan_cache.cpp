@@ -0,0 +1,126 @@
+/*******************************************************************************
+* Copyright 2018 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+/*****************************************************************************
+ ** Includes
+ *****************************************************************************/
+
+#include <cmath>
+#include "../include/thormang3_demo/footstep_plan_cache.hpp"
+
+/*****************************************************************************
+ ** Namespaces
+ *****************************************************************************/
+
+namespace thormang3_demo
+{
+
+/*****************************************************************************
+ ** Implementation
+ *****************************************************************************/
+
+bool FootstepPlanCache::Key::operator<(const Key &other) const
+{
+  if (x != other.x)
+    return x < other.x;
+  if (y != other.y)
+    return y < other.y;
+  return theta < other.theta;
+}
+
+FootstepPlanCache::FootstepPlanCache(int capacity, double position_resolution, double angle_resolution)
+    : capacity_(capacity),
+      position_resolution_(position_resolution),
+      angle_resolution_(angle_resolution),
+      map_version_(0)
+{
+}
+
+bool FootstepPlanCache::find(const geometry_msgs::Pose2D &goal, int map_version, Plan &plan)
+{
+  checkMapVersion(map_version);
+
+  std::map<Key, PlanList::iterator>::iterator table_it = plan_table_.find(makeKey(goal));
+  if (table_it == plan_table_.end())
+    return false;
+
+  // most recently used
+  plan_list_.splice(plan_list_.begin(), plan_list_, table_it->second);
+  plan = table_it->second->second;
+  return true;
+}
+
+void FootstepPlanCache::insert(const geometry_msgs::Pose2D &goal, int map_version, const Plan &plan)
+{
+  // planned on an outdated map
+  if (capacity_ <= 0 || map_version < map_version_)
+    return;
+
+  checkMapVersion(map_version);
+
+  Key key = makeKey(goal);
+  std::map<Key, PlanList::iterator>::iterator table_it = plan_table_.find(key);
+  if (table_it != plan_table_.end())
+  {
+    plan_list_.erase(table_it->second);
+    plan_table_.erase(table_it);
+  }
+
+  plan_list_.push_front(std::make_pair(key, plan));
+  plan_table_[key] = plan_list_.begin();
+
+  // drop the least recently used
+  if (plan_list_.size() > capacity_)
+  {
+    plan_table_.erase(plan_list_.back().first);
+    plan_list_.pop_back();
+  }
+}
+
+void FootstepPlanCache::clear()
+{
+  plan_list_.clear();
+  plan_table_.clear();
+}
+
+FootstepPlanCache::Key FootstepPlanCache::makeKey(const geometry_msgs::Pose2D &goal) const
+{
+  // theta : -pi ~ pi
+  double theta = std::atan2(std::sin(goal.theta), std::cos(goal.theta));
+
+  Key key;
+  key.x = static_cast<int>(std::floor(goal.x / position_resolution_ + 0.5));
+  key.y = static_cast<int>(std::floor(goal.y / position_resolution_ + 0.5));
+  key.theta = static_cast<int>(std::floor(theta / angle_resolution_ + 0.5));
+
+  // -pi and pi are the same angle
+  int angle_bin_num = static_cast<int>(std::floor(2 * M_PI / angle_resolution_ + 0.5));
+  if (angle_bin_num > 0 && key.theta * 2 >= angle_bin_num)
+    key.theta -= angle_bin_num;
+
+  return key;
+}
+
+void FootstepPlanCache::checkMapVersion(int map_version)
+{
+  if (map_version == map_version_)
+    return;
+
+  clear();
+  map_version_ = map_version;
+}
+
+}  // namespace thormang3_demo
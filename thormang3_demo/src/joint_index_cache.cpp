@@ -0,0 +1,107 @@
+/*******************************************************************************
+* Copyright 2018 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+/*****************************************************************************
+ ** Includes
+ *****************************************************************************/
+
+#include "../include/thormang3_demo/joint_index_cache.hpp"
+
+/*****************************************************************************
+ ** Namespaces
+ *****************************************************************************/
+
+namespace thormang3_demo
+{
+
+/*****************************************************************************
+ ** Implementation
+ *****************************************************************************/
+
+JointIndexCache::JointIndexCache()
+{
+}
+
+void JointIndexCache::setJointNames(const std::vector<std::string> &joint_names)
+{
+  joint_name_list_ = joint_names;
+
+  joint_name_table_.setNames(joint_name_list_);
+
+  // layouts are rebuilt at the next message
+  for (int ix = 0; ix < layout_list_.size(); ix++)
+  {
+    layout_list_[ix].is_built = false;
+    layout_list_[ix].msg_name_list.clear();
+    layout_list_[ix].msg_index_list.clear();
+  }
+}
+
+int JointIndexCache::getJointIndex(const std::string &joint_name) const
+{
+  return joint_name_table_.find(joint_name);
+}
+
+int JointIndexCache::addLayout()
+{
+  Layout layout;
+  layout.is_built = false;
+
+  layout_list_.push_back(layout);
+  return layout_list_.size() - 1;
+}
+
+void JointIndexCache::updateLayout(int layout_id, const std::vector<std::string> &msg_names)
+{
+  if (layout_id < 0 || layout_id >= layout_list_.size())
+    return;
+
+  Layout &layout = layout_list_[layout_id];
+
+  // the names of a topic rarely change, a joint can be also replaced without changing the number of names
+  if (layout.is_built == true && layout.msg_name_list == msg_names)
+    return;
+
+  buildLayout(layout, msg_names);
+}
+
+int JointIndexCache::getMsgIndex(int layout_id, int joint_index) const
+{
+  if (layout_id < 0 || layout_id >= layout_list_.size() || joint_index < 0 || joint_index >= joint_name_list_.size())
+    return -1;
+
+  const Layout &layout = layout_list_[layout_id];
+  if (layout.is_built == false)
+    return -1;
+
+  return layout.msg_index_list[joint_index];
+}
+
+void JointIndexCache::buildLayout(Layout &layout, const std::vector<std::string> &msg_names)
+{
+  layout.is_built = true;
+  layout.msg_name_list = msg_names;
+  layout.msg_index_list.assign(joint_name_list_.size(), -1);
+
+  for (int ix = 0; ix < msg_names.size(); ix++)
+  {
+    int joint_index = getJointIndex(msg_names[ix]);
+    if (joint_index != -1)
+      layout.msg_index_list[joint_index] = ix;
+  }
+}
+
+}  // namespace thormang3_demo
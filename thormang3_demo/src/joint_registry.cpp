@@ -0,0 +1,76 @@
+/*******************************************************************************
+* Copyright 2018 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+/*****************************************************************************
+ ** Includes
+ *****************************************************************************/
+
+#include "../include/thormang3_demo/joint_registry.hpp"
+
+/*****************************************************************************
+ ** Namespaces
+ *****************************************************************************/
+
+namespace thormang3_demo
+{
+
+/*****************************************************************************
+ ** Implementation
+ *****************************************************************************/
+
+JointRegistry::JointRegistry()
+{
+}
+
+void JointRegistry::setJoints(const std::map<int, std::string> &id_joint_table)
+{
+  joint_name_list_.clear();
+  joint_id_list_.clear();
+  joint_index_list_.clear();
+
+  for (std::map<int, std::string>::const_iterator map_it = id_joint_table.begin(); map_it != id_joint_table.end();
+      ++map_it)
+  {
+    // ids of the robot are small positive numbers
+    if (map_it->first < 0)
+      continue;
+
+    if (map_it->first >= joint_index_list_.size())
+      joint_index_list_.resize(map_it->first + 1, -1);
+    joint_index_list_[map_it->first] = joint_name_list_.size();
+
+    joint_name_list_.push_back(map_it->second);
+    joint_id_list_.push_back(map_it->first);
+  }
+
+  joint_name_table_.setNames(joint_name_list_);
+}
+
+void JointRegistry::setModules(const std::vector<std::string> &module_names)
+{
+  module_name_list_ = module_names;
+  module_name_table_.setNames(module_name_list_);
+}
+
+int JointRegistry::getJointIndexFromID(int id) const
+{
+  if (id < 0 || id >= joint_index_list_.size())
+    return -1;
+
+  return joint_index_list_[id];
+}
+
+}  // namespace thormang3_demo
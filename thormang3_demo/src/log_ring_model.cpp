@@ -0,0 +1,142 @@
+/*******************************************************************************
+* Copyright 2018 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+/*****************************************************************************
+ ** Includes
+ *****************************************************************************/
+
+#include "../include/thormang3_demo/log_ring_model.hpp"
+
+/*****************************************************************************
+ ** Namespaces
+ *****************************************************************************/
+
+namespace thormang3_demo
+{
+
+/*****************************************************************************
+ ** Implementation
+ *****************************************************************************/
+
+LogRingModel::LogRingModel(int capacity, int flush_interval_ms, QObject *parent)
+    : QAbstractListModel(parent),
+      capacity_(capacity > 0 ? capacity : 1),
+      first_row_(0),
+      row_count_(0),
+      first_pending_log_(0),
+      pending_log_count_(0)
+{
+  rows_.resize(capacity_);
+  pending_logs_.resize(capacity_);
+
+  QObject::connect(&flush_timer_, SIGNAL(timeout()), this, SLOT(flushPendingLogs()));
+  flush_timer_.start(flush_interval_ms);
+}
+
+LogRingModel::~LogRingModel()
+{
+  flush_timer_.stop();
+}
+
+int LogRingModel::rowCount(const QModelIndex &parent) const
+{
+  if (parent.isValid())
+    return 0;
+
+  return row_count_;
+}
+
+QVariant LogRingModel::data(const QModelIndex &index, int role) const
+{
+  if (index.isValid() == false || index.row() < 0 || index.row() >= row_count_)
+    return QVariant();
+
+  if (role != Qt::DisplayRole && role != Qt::EditRole)
+    return QVariant();
+
+  return rows_[(first_row_ + index.row()) % capacity_];
+}
+
+void LogRingModel::appendLog(const QString &log)
+{
+  QMutexLocker lock(&pending_mutex_);
+
+  // drop the oldest one when the logs come faster than the flush
+  if (pending_log_count_ == capacity_)
+  {
+    first_pending_log_ = (first_pending_log_ + 1) % capacity_;
+    pending_log_count_--;
+  }
+
+  pending_logs_[(first_pending_log_ + pending_log_count_) % capacity_] = log;
+  pending_log_count_++;
+}
+
+void LogRingModel::clear()
+{
+  QMutexLocker lock(&pending_mutex_);
+
+  beginResetModel();
+
+  for (int index = 0; index < capacity_; index++)
+  {
+    rows_[index] = QString();
+    pending_logs_[index] = QString();
+  }
+
+  first_row_ = 0;
+  row_count_ = 0;
+  first_pending_log_ = 0;
+  pending_log_count_ = 0;
+
+  endResetModel();
+}
+
+void LogRingModel::flushPendingLogs()
+{
+  {
+    QMutexLocker lock(&pending_mutex_);
+
+    if (pending_log_count_ == 0)
+      return;
+
+    // remove the oldest rows to make room for the pending logs
+    int overflow_count = row_count_ + pending_log_count_ - capacity_;
+    if (overflow_count > 0)
+    {
+      beginRemoveRows(QModelIndex(), 0, overflow_count - 1);
+      first_row_ = (first_row_ + overflow_count) % capacity_;
+      row_count_ -= overflow_count;
+      endRemoveRows();
+    }
+
+    beginInsertRows(QModelIndex(), row_count_, row_count_ + pending_log_count_ - 1);
+    for (int index = 0; index < pending_log_count_; index++)
+    {
+      QString &pending_log = pending_logs_[(first_pending_log_ + index) % capacity_];
+      rows_[(first_row_ + row_count_) % capacity_] = pending_log;
+      pending_log = QString();
+      row_count_++;
+    }
+    first_pending_log_ = 0;
+    pending_log_count_ = 0;
+    endInsertRows();
+  }
+
+  Q_EMIT logFlushed();  // used to readjust the scrollbar
+}
+
+}  // namespace thormang3_demo
@@ -24,6 +24,7 @@
 #include <QMessageBox>
 #include <iostream>
 #include "../include/thormang3_demo/main_window.hpp"
+#include "thormang3_foot_step_generator/rotation_math.h"
 
 /*****************************************************************************
  ** Namespaces
@@ -41,7 +42,8 @@ using namespace Qt;
 MainWindow::MainWindow(int argc, char** argv, QWidget *parent)
   : QMainWindow(parent),
     qnode_thor3_(argc, argv),
-    is_updating_(false)
+    is_updating_(false),
+    joint_state_table_(NULL)
 {
   // code to DEBUG
   debug_print_ = false;
@@ -68,32 +70,32 @@ MainWindow::MainWindow(int argc, char** argv, QWidget *parent)
   setWindowIcon(QIcon(":/images/icon.png"));
 
   ui_.tab_manager->setCurrentIndex(0);  // ensure the first tab is showing - qt-designer should have this already hardwired, but often loses it (settings?).
-  QObject::connect(&qnode_thor3_, SIGNAL(rosShutdown()), this, SLOT(close()));
+  QObject::connect(&qnode_thor3_, SIGNAL(rosShutdown()), this, SLOT(close()), Qt::QueuedConnection);
 
+  // signals emitted in ros callbacks are queued to the gui thread
   qRegisterMetaType<std::vector<int> >("std::vector<int>");
   QObject::connect(&qnode_thor3_, SIGNAL(updatePresentJointControlModules(std::vector<int>)), this,
-                   SLOT(updatePresentJointModule(std::vector<int>)));
-  QObject::connect(&qnode_thor3_, SIGNAL(updateHeadJointsAngle(double,double)), this,
-                   SLOT(updateHeadJointsAngle(double,double)));
+                   SLOT(updatePresentJointModule(std::vector<int>)), Qt::QueuedConnection);
 
   QObject::connect(ui_.head_pan_slider, SIGNAL(valueChanged(int)), this, SLOT(setHeadJointsAngle()));
   QObject::connect(ui_.head_tilt_slider, SIGNAL(valueChanged(int)), this, SLOT(setHeadJointsAngle()));
 
   QObject::connect(&qnode_thor3_, SIGNAL(updateCurrJoint(double)), this, SLOT(updateCurrJointSpinbox(double)));
   QObject::connect(&qnode_thor3_, SIGNAL(updateCurrPos(double , double , double)), this,
-                   SLOT(updateCurrPosSpinbox(double , double , double)));
+                   SLOT(updateCurrPosSpinbox(double , double , double)), Qt::QueuedConnection);
   QObject::connect(&qnode_thor3_, SIGNAL(updateCurrOri(double , double , double, double)), this,
-                   SLOT(updateCurrOriSpinbox(double , double , double , double)));
+                   SLOT(updateCurrOriSpinbox(double , double , double , double)), Qt::QueuedConnection);
 
   QObject::connect(ui_.tabWidget_control, SIGNAL(currentChanged(int)), &qnode_thor3_, SLOT(setCurrentControlUI(int)));
 
-  qRegisterMetaType<geometry_msgs::Point>("geometry_msgs::Point");
   qRegisterMetaType<geometry_msgs::Pose>("geometry_msgs::Pose");
-  connect(&qnode_thor3_, SIGNAL(updateDemoPoint(geometry_msgs::Point)), this,
-          SLOT(updatePointPanel(geometry_msgs::Point)));
-  connect(&qnode_thor3_, SIGNAL(updateDemoPose(geometry_msgs::Pose)), this, SLOT(updatePosePanel(geometry_msgs::Pose)));
+  connect(&qnode_thor3_, SIGNAL(updateDemoPose(geometry_msgs::Pose)), this, SLOT(updatePosePanel(geometry_msgs::Pose)),
+          Qt::QueuedConnection);
 
-  connect(&qnode_thor3_, SIGNAL(updateOverloadStatus(int,int,int,int)), this, SLOT(updateOverloadStatus(int,int,int,int)));
+  // head angles, current pose, marker pose, clicked points and overload status are polled from the qnode
+  QObject::connect(&frame_timer_, SIGNAL(timeout()), this, SLOT(updateFrame()));
+  QObject::connect(&qnode_thor3_, SIGNAL(commandRecordingAborted()), this, SLOT(abortCommandRecording()));
+  QObject::connect(&qnode_thor3_, SIGNAL(commandReplayFinished()), this, SLOT(finishCommandReplay()));
 
   /*********************
    ** Logging
@@ -106,9 +108,12 @@ MainWindow::MainWindow(int argc, char** argv, QWidget *parent)
    **********************/
   qnode_thor3_.init();
   initModeUnit();
+  initJointStateUnit();
   setUserShortcut();
   updateModuleUI();
   clearOverload();
+
+  frame_timer_.start(FRAME_INTERVAL_MS);
 }
 
 MainWindow::~MainWindow()
@@ -392,9 +397,11 @@ void MainWindow::on_button_manipulation_demo_0_clicked(bool check)
 
 void MainWindow::on_button_manipulation_demo_1_clicked(bool check)
 {
-  // manipulation mode
-  qnode_thor3_.enableControlModule("manipulation_module");
-  qnode_thor3_.enableControlModule("gripper_module");
+  // manipulation mode, arms and grippers are set in one message
+  std::vector<std::string> modules;
+  modules.push_back("manipulation_module");
+  modules.push_back("gripper_module");
+  qnode_thor3_.enableControlModules(modules);
 }
 
 void MainWindow::on_button_manipulation_demo_2_clicked(bool check)
@@ -405,14 +412,9 @@ void MainWindow::on_button_manipulation_demo_2_clicked(bool check)
 
 void MainWindow::on_button_manipulation_demo_3_clicked(bool check)
 {
-  // head control mode
-  qnode_thor3_.enableControlModule("head_control_module");
-
-  // wait for setting the module
-  usleep(10 * 1000);
-
-  // scan
-  qnode_thor3_.assembleLidar();
+  // head control mode, scan after setting the module
+  qnode_thor3_.enableControlModule("head_control_module",
+                                   boost::bind(&QNodeThor3::assembleLidar, &qnode_thor3_));
 }
 
 void MainWindow::on_button_manipulation_demo_4_clicked(bool check)
@@ -438,27 +440,7 @@ void MainWindow::on_button_manipulation_demo_5_clicked(bool check)
 {
   // send pose
   thormang3_manipulation_module_msgs::KinematicsPose msg;
-  double z_offset = 0.723;
-
-  // arm group : left_arm_with_torso / right_arm_with_torso
-  std::string selected_arm = ui_.comboBox_arm_group->currentText().toStdString();
-  std::string arm_group = (selected_arm == "Right Arm") ? "right_arm_with_torso" : "left_arm_with_torso";
-  msg.name = arm_group;
-
-  msg.pose.position.x = ui_.dSpinBox_marker_pos_x->value() + ui_.dSpinBox_offset_x->value();
-  msg.pose.position.y = ui_.dSpinBox_marker_pos_y->value() + ui_.dSpinBox_offset_y->value();
-  msg.pose.position.z = ui_.dSpinBox_marker_pos_z->value() + ui_.dSpinBox_offset_z->value() + z_offset;
-
-  double roll = deg2rad<double>(ui_.dSpinBox_marker_ori_r->value());
-  double pitch = deg2rad<double>(ui_.dSpinBox_marker_ori_p->value());
-  double yaw = deg2rad<double>(ui_.dSpinBox_marker_ori_y->value());
-
-  Eigen::Quaterniond orientation = rpy2quaternion(roll, pitch, yaw);
-
-  msg.pose.orientation.x = orientation.x();
-  msg.pose.orientation.y = orientation.y();
-  msg.pose.orientation.z = orientation.z();
-  msg.pose.orientation.w = orientation.w();
+  getIkTargetFromMarkerPanel(msg);
 
   qnode_thor3_.sendIkMsg(msg);
 
@@ -467,6 +449,15 @@ void MainWindow::on_button_manipulation_demo_5_clicked(bool check)
   qnode_thor3_.clearFootsteps();
 }
 
+void MainWindow::on_checkBox_ik_streaming_toggled(bool checked)
+{
+  // the pose of the marker panel is streamed at every frame
+  if (checked == true)
+    qnode_thor3_.startIkStreaming();
+  else
+    qnode_thor3_.stopIkStreaming();
+}
+
 void MainWindow::on_button_manipulation_demo_6_clicked(bool check)
 {
   // grip on : l_arm_grip / r_arm_grip
@@ -494,26 +485,16 @@ void MainWindow::on_button_walking_demo_0_clicked(bool check)
 
 void MainWindow::on_button_walking_demo_1_clicked(bool check)
 {
-  // head control mode
-  qnode_thor3_.enableControlModule("head_control_module");
-
-  // wait for setting the module
-  usleep(10 * 1000);
-
-  // scan
-  qnode_thor3_.assembleLidar();
+  // head control mode, scan after setting the module
+  qnode_thor3_.enableControlModule("head_control_module",
+                                   boost::bind(&QNodeThor3::assembleLidar, &qnode_thor3_));
 }
 
 void MainWindow::on_button_walking_demo_2_clicked(bool check)
 {
-  // walking mode
-  qnode_thor3_.enableControlModule("walking_module");
-
-  // wait for setting module
-  usleep(10 * 1000);
-
-  // balance on
-  qnode_thor3_.setWalkingBalance(true);
+  // walking mode, balance on after setting the module
+  qnode_thor3_.enableControlModule("walking_module",
+                                   boost::bind(&QNodeThor3::setWalkingBalance, &qnode_thor3_, true));
 }
 
 void MainWindow::on_button_walking_demo_3_clicked(bool check)
@@ -558,14 +539,9 @@ void MainWindow::on_button_walking_demo_5_clicked(bool check)
 
 void MainWindow::on_button_walking_demo_6_clicked(bool check)
 {
-  // head control mode
-  qnode_thor3_.enableControlModule("head_control_module");
-
-  // wait for setting the module
-  usleep(10 * 1000);
-
-  // scan
-  qnode_thor3_.assembleLidar();
+  // head control mode, scan after setting the module
+  qnode_thor3_.enableControlModule("head_control_module",
+                                   boost::bind(&QNodeThor3::assembleLidar, &qnode_thor3_));
 }
 
 void MainWindow::on_button_walking_demo_7_clicked(bool check)
@@ -648,12 +624,16 @@ void MainWindow::setUserShortcut()
 
 void MainWindow::updatePresentJointModule(std::vector<int> mode)
 {
-  QList<QComboBox *> combo_children = ui_.widget_mode->findChildren<QComboBox *>();
+  bool is_changed = false;
 
-  for (int ix = 0; ix < combo_children.length(); ix++)
+  for (int ix = 0; ix < joint_module_combo_list_.size() && ix < mode.size(); ix++)
   {
-    int control_index = mode.at(ix);
-    combo_children.at(ix)->setCurrentIndex(control_index);
+    if (joint_module_combo_list_[ix] == NULL || shown_joint_modules_[ix] == mode[ix])
+      continue;
+
+    shown_joint_modules_[ix] = mode[ix];
+    joint_module_combo_list_[ix]->setCurrentIndex(mode[ix]);
+    is_changed = true;
 
     if (debug_print_)
     {
@@ -661,7 +641,7 @@ void MainWindow::updatePresentJointModule(std::vector<int> mode)
       std::string joint_name;
       int id;
 
-      std::string control_mode = combo_children.at(ix)->currentText().toStdString();
+      std::string control_mode = joint_module_combo_list_[ix]->currentText().toStdString();
 
       bool result = qnode_thor3_.getIDJointNameFromIndex(ix, id, joint_name);
       if (result == true)
@@ -674,7 +654,8 @@ void MainWindow::updatePresentJointModule(std::vector<int> mode)
   }
 
   // set module UI
-  updateModuleUI();
+  if (is_changed == true)
+    updateModuleUI();
 }
 
 void MainWindow::updateModuleUI()
@@ -682,22 +663,19 @@ void MainWindow::updateModuleUI()
   if (debug_print_)
     return;
 
-  for (int index = 0; index < qnode_thor3_.getModuleTableSize(); index++)
+  for (int index = 0; index < module_widget_list_.size(); index++)
   {
-    std::string mode = qnode_thor3_.getModuleName(index);
-    if (mode == "")
+    const QList<QWidget *> &list = module_widget_list_[index];
+    if (list.empty() == true)
       continue;
 
-    std::map<std::string, QList<QWidget *> >::iterator module_iter = module_ui_table_.find(mode);
-    if (module_iter == module_ui_table_.end())
+    int is_enable = qnode_thor3_.isUsingModule(qnode_thor3_.getModuleName(index)) ? 1 : 0;
+    if (shown_module_enabled_[index] == is_enable)
       continue;
 
-    QList<QWidget *> list = module_iter->second;
+    shown_module_enabled_[index] = is_enable;
     for (int ix = 0; ix < list.size(); ix++)
-    {
-      bool is_enable = qnode_thor3_.isUsingModule(mode);
-      list.at(ix)->setEnabled(is_enable);
-    }
+      list.at(ix)->setEnabled(is_enable == 1);
   }
 }
 
@@ -721,6 +699,78 @@ void MainWindow::updateHeadJointsAngle(double pan, double tilt)
   is_updating_ = false;
 }
 
+void MainWindow::updateFrame()
+{
+  QNodeThor3::HeadJointsAngle head_angle;
+  if (qnode_thor3_.takeHeadJointsAngle(head_angle) == true)
+    updateHeadJointsAngle(head_angle.pan, head_angle.tilt);
+
+  geometry_msgs::Pose curr_pose;
+  if (qnode_thor3_.takeCurrPose(curr_pose) == true)
+  {
+    updateCurrPosSpinbox(curr_pose.position.x, curr_pose.position.y, curr_pose.position.z);
+    updateCurrOriSpinbox(curr_pose.orientation.x, curr_pose.orientation.y, curr_pose.orientation.z,
+                         curr_pose.orientation.w);
+  }
+
+  // the latest pose of the dragged marker, and the latest one from the panel to the marker
+  geometry_msgs::Pose marker_pose;
+  if (qnode_thor3_.takeMarkerPose(marker_pose) == true)
+    updatePosePanel(marker_pose);
+  qnode_thor3_.flushInteractiveMarker();
+
+  if (qnode_thor3_.isIkStreaming() == true)
+  {
+    thormang3_manipulation_module_msgs::KinematicsPose ik_target;
+    getIkTargetFromMarkerPanel(ik_target);
+    qnode_thor3_.setIkStreamingTarget(ik_target);
+  }
+
+  geometry_msgs::Point demo_point;
+  while (qnode_thor3_.takeDemoPoint(demo_point) == true)
+    updatePointPanel(demo_point);
+
+  QNodeThor3::OverloadState overload_state;
+  if (qnode_thor3_.takeOverloadState(QNodeThor3::Right, overload_state) == true)
+    updateOverloadStatus(QNodeThor3::Right, overload_state.status, overload_state.warning_count,
+                         overload_state.error_count);
+  if (qnode_thor3_.takeOverloadState(QNodeThor3::Left, overload_state) == true)
+    updateOverloadStatus(QNodeThor3::Left, overload_state.status, overload_state.warning_count,
+                         overload_state.error_count);
+
+  QNodeThor3::WalkingCommandLatency walking_command_latency;
+  if (qnode_thor3_.takeWalkingCommandLatency(walking_command_latency) == true)
+    updateWalkingCommandLatency(walking_command_latency);
+
+  updateJointStateTable();
+}
+
+void MainWindow::updateJointStateTable()
+{
+  // take it even if the table is hidden, to show the latest one at first
+  const JointStateSample *sample = qnode_thor3_.takeJointStateSample();
+  if (sample == NULL)
+    return;
+
+  if (ui_.tab_manager->currentWidget() != joint_state_table_)
+    return;
+
+  for (int row = 0; row < joint_state_table_->rowCount() && row < sample->position.size(); row++)
+  {
+    const double values[3] = { rad2deg<double>(sample->position[row]), sample->velocity[row], sample->effort[row] };
+
+    for (int col = 0; col < 3; col++)
+    {
+      // NaN : the joint is not in the message
+      QString text = (values[col] != values[col]) ? QString("-") : QString::number(values[col], 'f', 2);
+
+      QTableWidgetItem *item = joint_state_table_->item(row, col + 1);
+      if (item->text() != text)
+        item->setText(text);
+    }
+  }
+}
+
 void MainWindow::setHeadJointsAngle()
 {
   if (is_updating_ == true)
@@ -796,6 +846,29 @@ void MainWindow::sendWalkingCommand(const std::string &command)
   qnode_thor3_.setWalkingCommand(msg);
 }
 
+// breakdown of the last walking command reported by the foot step generator
+void MainWindow::updateWalkingCommandLatency(const QNodeThor3::WalkingCommandLatency &latency)
+{
+  const QString stage_names[6] = { "Sent", "Reference step", "Step generation", "Module acceptance", "Total",
+                                   "Walking start" };
+  const double stage_latency[6] = { latency.sent, latency.ref_step, latency.generation, latency.acceptance,
+                                    latency.total, latency.walking_start };
+
+  QString text = QString("#%1 %2").arg(latency.command_id).arg(QString::fromStdString(latency.command));
+  if (latency.result != 0)
+    text += QString(" (failed : %1)").arg(latency.result);
+
+  for (int ix = 0; ix < 6; ix++)
+  {
+    // NaN : the stage is not known
+    QString latency_text =
+        (stage_latency[ix] != stage_latency[ix]) ? QString("-") : QString::number(stage_latency[ix], 'f', 1) + " ms";
+    text += QString("\n%1 : %2").arg(stage_names[ix]).arg(latency_text);
+  }
+
+  ui_.label_command_latency->setText(text);
+}
+
 // Update UI - position
 void MainWindow::updatePointPanel(const geometry_msgs::Point point)
 {
@@ -833,6 +906,22 @@ void MainWindow::getPoseFromMarkerPanel(geometry_msgs::Pose &current)
   tf::quaternionEigenToMsg(orientation, current.orientation);
 }
 
+// ik target of the selected arm : marker pose with the offset, from the pelvis
+void MainWindow::getIkTargetFromMarkerPanel(thormang3_manipulation_module_msgs::KinematicsPose &target)
+{
+  double z_offset = 0.723;
+
+  // arm group : left_arm_with_torso / right_arm_with_torso
+  std::string selected_arm = ui_.comboBox_arm_group->currentText().toStdString();
+  std::string arm_group = (selected_arm == "Right Arm") ? "right_arm_with_torso" : "left_arm_with_torso";
+  target.name = arm_group;
+
+  getPoseFromMarkerPanel(target.pose);
+  target.pose.position.x += ui_.dSpinBox_offset_x->value();
+  target.pose.position.y += ui_.dSpinBox_offset_y->value();
+  target.pose.position.z += ui_.dSpinBox_offset_z->value() + z_offset;
+}
+
 void MainWindow::setPoseToMarkerPanel(const geometry_msgs::Pose &current)
 {
   // position
@@ -1024,6 +1113,63 @@ void MainWindow::on_actionAbout_triggered()
   QMessageBox::about(this, tr("About ..."), tr("<h2>THORMANG3 Demo</h2><p>Copyright Robotis</p>"));
 }
 
+void MainWindow::on_action_record_commands_toggled(bool checked)
+{
+  if (checked == false)
+  {
+    qnode_thor3_.stopRecordingCommands();
+    return;
+  }
+
+  QString path = QFileDialog::getSaveFileName(this, tr("Record Commands"), QDir::homePath(),
+                                              tr("Command Log (*.cmdlog)"));
+
+  if (path.isEmpty() == true || qnode_thor3_.startRecordingCommands(path.toStdString()) == false)
+  {
+    ui_.action_record_commands->blockSignals(true);
+    ui_.action_record_commands->setChecked(false);
+    ui_.action_record_commands->blockSignals(false);
+  }
+}
+
+void MainWindow::on_action_replay_commands_triggered()
+{
+  replayCommands(true);
+}
+
+void MainWindow::on_action_replay_commands_fast_triggered()
+{
+  replayCommands(false);
+}
+
+void MainWindow::on_action_stop_replay_triggered()
+{
+  qnode_thor3_.stopReplayingCommands();
+}
+
+void MainWindow::replayCommands(bool real_time)
+{
+  QString path = QFileDialog::getOpenFileName(this, tr("Replay Commands"), QDir::homePath(),
+                                              tr("Command Log (*.cmdlog)"));
+  if (path.isEmpty() == true)
+    return;
+
+  if (qnode_thor3_.replayCommands(path.toStdString(), real_time) == true)
+    ui_.action_stop_replay->setEnabled(true);
+}
+
+void MainWindow::abortCommandRecording()
+{
+  ui_.action_record_commands->blockSignals(true);
+  ui_.action_record_commands->setChecked(false);
+  ui_.action_record_commands->blockSignals(false);
+}
+
+void MainWindow::finishCommandReplay()
+{
+  ui_.action_stop_replay->setEnabled(false);
+}
+
 /*****************************************************************************
  ** Implementation [Configuration]
  *****************************************************************************/
@@ -1056,6 +1202,9 @@ void MainWindow::initModeUnit()
   ui_.widget_mode_preset->setLayout(preset_layout);
 
   // joints
+  joint_module_combo_list_.assign(number_joint, NULL);
+  shown_joint_modules_.assign(number_joint, -1);
+
   QGridLayout *grid_mod = new QGridLayout;
   for (int ix = 0; ix < number_joint; ix++)
   {
@@ -1084,6 +1233,7 @@ void MainWindow::initModeUnit()
     combo->setObjectName(tr(joint.c_str()));
     combo->addItems(list);
     combo->setEnabled(false);      // not changable
+    joint_module_combo_list_[ix] = combo;
     int row = ix / 2 + 1;
     int col = (ix % 2) * 3;
     grid_mod->addWidget(label, row, col, 1, 1);
@@ -1098,6 +1248,9 @@ void MainWindow::initModeUnit()
   ui_.widget_mode->setLayout(grid_mod);
 
   // make module widget table
+  module_widget_list_.assign(qnode_thor3_.getModuleTableSize(), QList<QWidget *>());
+  shown_module_enabled_.assign(qnode_thor3_.getModuleTableSize(), -1);
+
   for (int index = 0; index < qnode_thor3_.getModuleTableSize(); index++)
   {
     std::string mode = qnode_thor3_.getModuleName(index);
@@ -1109,7 +1262,7 @@ void MainWindow::initModeUnit()
     rx.setPatternSyntax(QRegExp::Wildcard);
 
     QList<QWidget *> list = ui_.centralwidget->findChildren<QWidget *>(rx);
-    module_ui_table_[mode] = list;
+    module_widget_list_[index] = list;
 
     if (debug_print_)
       std::cout << "Module widget : " << mode << " [" << list.size() << "]" << std::endl;
@@ -1120,6 +1273,43 @@ void MainWindow::initModeUnit()
     initMotionUnit();
 }
 
+void MainWindow::initJointStateUnit()
+{
+  int number_joint = qnode_thor3_.getJointTableSize();
+
+  joint_state_table_ = new QTableWidget(number_joint, 4);
+
+  QStringList header;
+  header << "Joint" << "Position [deg]" << "Velocity" << "Effort";
+  joint_state_table_->setHorizontalHeaderLabels(header);
+  joint_state_table_->verticalHeader()->setVisible(false);
+  joint_state_table_->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  joint_state_table_->setSelectionMode(QAbstractItemView::NoSelection);
+
+  // row : joint index of the qnode
+  for (int ix = 0; ix < number_joint; ix++)
+  {
+    std::stringstream stream;
+    std::string joint;
+    int id = 0;
+
+    qnode_thor3_.getIDJointNameFromIndex(ix, id, joint);
+    stream << "[" << (id < 10 ? "0" : "") << id << "] " << joint;
+
+    joint_state_table_->setItem(ix, 0, new QTableWidgetItem(tr(stream.str().c_str())));
+    for (int col = 1; col < 4; col++)
+    {
+      QTableWidgetItem *item = new QTableWidgetItem("-");
+      item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+      joint_state_table_->setItem(ix, col, item);
+    }
+  }
+  joint_state_table_->resizeColumnsToContents();
+
+  // refreshed on the frame timer with the latest joint states, not per message
+  ui_.tab_manager->addTab(joint_state_table_, tr("Joint States"));
+}
+
 void MainWindow::initMotionUnit()
 {
   // preset button
@@ -1196,24 +1386,6 @@ void MainWindow::closeEvent(QCloseEvent *event)
  ** Implementation [Util]
  *****************************************************************************/
 // math : euler & quaternion & rotation mat
-Eigen::Vector3d MainWindow::rotation2rpy(const Eigen::MatrixXd &rotation)
-{
-  Eigen::Vector3d rpy;
-
-  rpy[0] = atan2(rotation.coeff(2, 1), rotation.coeff(2, 2));
-  rpy[1] = atan2(-rotation.coeff(2, 0), sqrt(pow(rotation.coeff(2, 1), 2) + pow(rotation.coeff(2, 2), 2)));
-  rpy[2] = atan2(rotation.coeff(1, 0), rotation.coeff(0, 0));
-
-  return rpy;
-}
-
-Eigen::MatrixXd MainWindow::rpy2rotation(const double &roll, const double &pitch, const double &yaw)
-{
-  Eigen::MatrixXd rotation = rotationZ(yaw) * rotationY(pitch) * rotationX(roll);
-
-  return rotation;
-}
-
 Eigen::Quaterniond MainWindow::rpy2quaternion(const Eigen::Vector3d &euler)
 {
   return rpy2quaternion(euler[0], euler[1], euler[2]);
@@ -1221,35 +1393,12 @@ Eigen::Quaterniond MainWindow::rpy2quaternion(const Eigen::Vector3d &euler)
 
 Eigen::Quaterniond MainWindow::rpy2quaternion(const double &roll, const double &pitch, const double &yaw)
 {
-  Eigen::MatrixXd rotation = rpy2rotation(roll, pitch, yaw);
-
-  Eigen::Matrix3d rotation3d;
-  rotation3d = rotation.block(0, 0, 3, 3);
-
-  Eigen::Quaterniond quaternion;
-
-  quaternion = rotation3d;
-
-  return quaternion;
-}
-
-Eigen::Quaterniond MainWindow::rotation2quaternion(const Eigen::MatrixXd &rotation)
-{
-  Eigen::Matrix3d rotation3d;
-
-  rotation3d = rotation.block(0, 0, 3, 3);
-
-  Eigen::Quaterniond quaternion;
-  quaternion = rotation3d;
-
-  return quaternion;
+  return thormang3::rotation_math::rpy2quaternion(roll, pitch, yaw);
 }
 
 Eigen::Vector3d MainWindow::quaternion2rpy(const Eigen::Quaterniond &quaternion)
 {
-  Eigen::Vector3d rpy = rotation2rpy(quaternion.toRotationMatrix());
-
-  return rpy;
+  return thormang3::rotation_math::quaternion2rpy(quaternion);
 }
 
 Eigen::Vector3d MainWindow::quaternion2rpy(const geometry_msgs::Quaternion &quaternion)
@@ -1257,43 +1406,7 @@ Eigen::Vector3d MainWindow::quaternion2rpy(const geometry_msgs::Quaternion &quat
   Eigen::Quaterniond eigen_quaternion;
   tf::quaternionMsgToEigen(quaternion, eigen_quaternion);
 
-  Eigen::Vector3d rpy = rotation2rpy(eigen_quaternion.toRotationMatrix());
-
-  return rpy;
-}
-
-Eigen::MatrixXd MainWindow::quaternion2rotation(const Eigen::Quaterniond &quaternion)
-{
-  Eigen::MatrixXd rotation = quaternion.toRotationMatrix();
-
-  return rotation;
-}
-
-Eigen::MatrixXd MainWindow::rotationX(const double &angle)
-{
-  Eigen::MatrixXd rotation(3, 3);
-
-  rotation << 1.0, 0.0, 0.0, 0.0, cos(angle), -sin(angle), 0.0, sin(angle), cos(angle);
-
-  return rotation;
-}
-
-Eigen::MatrixXd MainWindow::rotationY(const double &angle)
-{
-  Eigen::MatrixXd rotation(3, 3);
-
-  rotation << cos(angle), 0.0, sin(angle), 0.0, 1.0, 0.0, -sin(angle), 0.0, cos(angle);
-
-  return rotation;
-}
-
-Eigen::MatrixXd MainWindow::rotationZ(const double &angle)
-{
-  Eigen::MatrixXd rotation(3, 3);
-
-  rotation << cos(angle), -sin(angle), 0.0, sin(angle), cos(angle), 0.0, 0.0, 0.0, 1.0;
-
-  return rotation;
+  return thormang3::rotation_math::quaternion2rpy(eigen_quaternion);
 }
 
 }  // namespace thormang3_demo
@@ -0,0 +1,104 @@
+/*******************************************************************************
+* Copyright 2018 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+/*****************************************************************************
+ ** Includes
+ *****************************************************************************/
+
+#include "../include/thormang3_demo/name_index_table.hpp"
+
+/*****************************************************************************
+ ** Namespaces
+ *****************************************************************************/
+
+namespace thormang3_demo
+{
+
+/*****************************************************************************
+ ** Implementation
+ *****************************************************************************/
+
+NameIndexTable::NameIndexTable()
+    : slot_mask_(0),
+      seed_(0)
+{
+}
+
+void NameIndexTable::setNames(const std::vector<std::string> &names)
+{
+  name_list_ = names;
+
+  // at least twice the names, a power of two to mask the hash
+  unsigned int slot_size = 1;
+  while (slot_size < 2 * name_list_.size())
+    slot_size <<= 1;
+
+  while (true)
+  {
+    for (unsigned int seed = 0; seed < MAX_SEED_TRIAL; seed++)
+    {
+      if (buildSlots(slot_size, seed) == true)
+        return;
+    }
+
+    slot_size <<= 1;
+  }
+}
+
+int NameIndexTable::find(const std::string &name) const
+{
+  if (slot_list_.empty() == true)
+    return -1;
+
+  int name_index = slot_list_[hashName(name, seed_) & slot_mask_];
+  if (name_index == -1 || name_list_[name_index] != name)
+    return -1;
+
+  return name_index;
+}
+
+// FNV-1a started from the seed
+unsigned int NameIndexTable::hashName(const std::string &name, unsigned int seed)
+{
+  unsigned int hash = 2166136261u ^ (seed * 16777619u);
+  for (int ix = 0; ix < name.size(); ix++)
+  {
+    hash ^= static_cast<unsigned char>(name[ix]);
+    hash *= 16777619u;
+  }
+
+  return hash;
+}
+
+bool NameIndexTable::buildSlots(unsigned int slot_size, unsigned int seed)
+{
+  slot_list_.assign(slot_size, -1);
+  slot_mask_ = slot_size - 1;
+  seed_ = seed;
+
+  for (int ix = 0; ix < name_list_.size(); ix++)
+  {
+    int &slot = slot_list_[hashName(name_list_[ix], seed_) & slot_mask_];
+    if (slot == -1)
+      slot = ix;
+    else if (name_list_[slot] != name_list_[ix])
+      return false;
+  }
+
+  return true;
+}
+
+}  // namespace thormang3_demo
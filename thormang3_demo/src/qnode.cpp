@@ -20,6 +20,9 @@
  ** Includes
  *****************************************************************************/
 
+#include <sys/stat.h>
+#include <algorithm>
+#include <ros/serialization.h>
 #include "../include/thormang3_demo/qnode.hpp"
 
 /*****************************************************************************
@@ -29,6 +32,46 @@
 namespace thormang3_demo
 {
 
+/*****************************************************************************
+ ** Helpers
+ *****************************************************************************/
+
+// 0 if the file can not be read
+static time_t getFileModifiedTime(const std::string &file_path)
+{
+  struct stat file_stat;
+  if (stat(file_path.c_str(), &file_stat) != 0)
+    return 0;
+
+  return file_stat.st_mtime;
+}
+
+// a walking command or planned footsteps start the walking of the standing robot,
+// "stop" and the appended footsteps do not
+static bool isWalkingStartCommand(const std::string &command)
+{
+  return command == "forward" || command == "backward" || command == "turn left" || command == "turn right"
+      || command == "left" || command == "right" || command == "left kick" || command == "right kick"
+      || command == "footsteps_2d";
+}
+
+// the messages have no compare operator, they are compared in the serialized form
+template<class Message>
+static bool isSameMessage(const Message &lhs, const Message &rhs)
+{
+  uint32_t length = ros::serialization::serializationLength(lhs);
+  if (length != ros::serialization::serializationLength(rhs))
+    return false;
+
+  std::vector<uint8_t> lhs_buffer(length), rhs_buffer(length);
+  ros::serialization::OStream lhs_stream(&lhs_buffer[0], length);
+  ros::serialization::OStream rhs_stream(&rhs_buffer[0], length);
+  ros::serialization::serialize(lhs_stream, lhs);
+  ros::serialization::serialize(rhs_stream, rhs);
+
+  return lhs_buffer == rhs_buffer;
+}
+
 /*****************************************************************************
  ** Implementation
  *****************************************************************************/
@@ -37,8 +80,54 @@ QNodeThor3::QNodeThor3(int argc, char** argv)
     : init_argc_(argc),
       init_argv_(argv),
       marker_name_("THORMANG3_demo_marker"),
-      frame_id_("pelvis_link")
+      frame_id_("pelvis_link"),
+      logging_model_(LOG_CAPACITY),
+      service_request_pool_(SERVICE_THREAD_NUM),
+      balance_yaml_modified_time_(0),
+      joint_feedback_yaml_modified_time_(0),
+      is_balance_param_sent_(false),
+      is_joint_feedback_gain_sent_(false),
+      last_walking_command_id_(0),
+      is_walking_start_pending_(false),
+      map_version_(0),
+      footstep_execution_horizon_(0),
+      is_rest_footsteps_pending_(false),
+      is_walking_finished_before_rest_(false),
+      footstep_plan_cache_(FOOTSTEP_PLAN_CACHE_SIZE, FOOTSTEP_PLAN_CACHE_POSITION_RESOLUTION,
+                           FOOTSTEP_PLAN_CACHE_ANGLE_RESOLUTION),
+      is_marker_dragged_(false),
+      is_marker_shown_(false),
+      is_marker_pose_pending_(false),
+      is_applied_marker_pose_valid_(false),
+      is_ik_streaming_(false),
+      has_ik_streaming_target_(false),
+      has_sent_ik_streaming_pose_(false),
+      ik_streaming_rate_(IK_STREAMING_RATE),
+      ik_streaming_position_deadband_(IK_STREAMING_POSITION_DEADBAND),
+      ik_streaming_angle_deadband_(IK_STREAMING_ANGLE_DEADBAND),
+      ik_streaming_linear_speed_(IK_STREAMING_LINEAR_SPEED),
+      ik_streaming_angular_speed_(IK_STREAMING_ANGULAR_SPEED),
+      is_replaying_commands_(false),
+      is_real_time_replay_(true),
+      replayed_command_count_(0),
+      kick_demo_state_(KickDemoIdle),
+      demo_point_channel_(DEMO_POINT_CHANNEL_SIZE)
 {
+  QObject::connect(&logging_model_, SIGNAL(logFlushed()), this, SIGNAL(loggingUpdated()));
+  QObject::connect(&service_request_pool_, SIGNAL(requestFinished(int, QString, int)), this,
+                   SLOT(serviceRequestFinished(int, QString, int)));
+
+  // demo sequence is driven by the status from the robot
+  QObject::connect(this, SIGNAL(controlModuleUpdated()), this, SLOT(updatePresentJointModules()),
+                   Qt::QueuedConnection);
+  QObject::connect(&module_action_timer_, SIGNAL(timeout()), this, SLOT(runModuleActions()));
+  QObject::connect(this, SIGNAL(walkingStatusFinished()), this, SLOT(walkingFinished()), Qt::QueuedConnection);
+  kick_demo_timer_.setSingleShot(true);
+  QObject::connect(&kick_demo_timer_, SIGNAL(timeout()), this, SLOT(kickDemoTimeout()));
+  QObject::connect(&ik_streaming_timer_, SIGNAL(timeout()), this, SLOT(streamIkTarget()));
+  command_replay_timer_.setSingleShot(true);
+  QObject::connect(&command_replay_timer_, SIGNAL(timeout()), this, SLOT(replayNextCommand()));
+
   // code to DEBUG
   debug_print_ = false;
 
@@ -76,17 +165,23 @@ bool QNodeThor3::init()
 
   ros::NodeHandle nh;
 
+  // high rate topics and status topics are spun by their own threads, see run()
+  ros::NodeHandle sensor_nh;
+  sensor_nh.setCallbackQueue(&sensor_callback_queue_);
+  ros::NodeHandle status_nh;
+  status_nh.setCallbackQueue(&status_callback_queue_);
+
   package_name_ = ros::package::getPath("thormang3_demo");
 
   balance_yaml_path_ = nh.param<std::string>("balance_file_path", package_name_ + "/config/balance_param.yaml");
   joint_feedback_yaml_path_ = nh.param<std::string>("joint_feedback_file_path", package_name_ + "/config/joint_feedback_gain.yaml");
 
   // Add your ros communications here.
-  status_msg_sub_ = nh.subscribe("/robotis/status", 10, &QNodeThor3::statusMsgCallback, this);
-  current_module_control_sub_ = nh.subscribe("/robotis/present_joint_ctrl_modules", 10,
-                                             &QNodeThor3::refreshCurrentJointControlCallback, this);
-  current_joint_states_sub_ = nh.subscribe("/robotis/present_joint_states", 10,
-                                           &QNodeThor3::updateHeadJointStatesCallback, this);
+  status_msg_sub_ = status_nh.subscribe("/robotis/status", 10, &QNodeThor3::statusMsgCallback, this);
+  current_module_control_sub_ = status_nh.subscribe("/robotis/present_joint_ctrl_modules", 10,
+                                                    &QNodeThor3::refreshCurrentJointControlCallback, this);
+  current_joint_states_sub_ = sensor_nh.subscribe("/robotis/present_joint_states", 10,
+                                                  &QNodeThor3::updateHeadJointStatesCallback, this);
 
   get_module_control_client_ = nh.serviceClient<robotis_controller_msgs::GetJointModule>(
       "/robotis/get_present_joint_ctrl_modules");
@@ -97,17 +192,23 @@ bool QNodeThor3::init()
   init_pose_pub_ = nh.advertise<std_msgs::String>("/robotis/base/ini_pose", 0);
   init_ft_pub_ = nh.advertise<std_msgs::String>("/robotis/feet_ft/ft_calib_command", 0);
 
-  init_ft_foot_sub_ = nh.subscribe("/robotis/feet_ft/both_ft_value", 10, &QNodeThor3::initFTFootCallback, this);
+  init_ft_foot_sub_ = sensor_nh.subscribe("/robotis/feet_ft/both_ft_value", 10, &QNodeThor3::initFTFootCallback,
+                                          this);
 
   // demo
-  rviz_clicked_point_sub_ = nh.subscribe("clicked_point", 0, &QNodeThor3::pointStampedCallback, this);
+  rviz_clicked_point_sub_ = status_nh.subscribe("clicked_point", 0, &QNodeThor3::pointStampedCallback, this);
   interactive_marker_server_.reset(new interactive_markers::InteractiveMarkerServer("THORMANG_Pose", "", false));
 
   // Manipulation
-  kenematics_pose_sub_ = nh.subscribe("/thormang3_demo/ik_target_pose", 10, &QNodeThor3::getKinematicsPoseCallback,
-                                      this);
+  kenematics_pose_sub_ = sensor_nh.subscribe("/thormang3_demo/ik_target_pose", 10,
+                                             &QNodeThor3::getKinematicsPoseCallback, this);
 
   send_ini_pose_msg_pub_ = nh.advertise<std_msgs::String>("/robotis/manipulation/ini_pose_msg", 0);
+  ik_streaming_rate_ = nh.param<double>("ik_streaming_rate", IK_STREAMING_RATE);
+  ik_streaming_position_deadband_ = nh.param<double>("ik_streaming_position_deadband", IK_STREAMING_POSITION_DEADBAND);
+  ik_streaming_angle_deadband_ = nh.param<double>("ik_streaming_angle_deadband", IK_STREAMING_ANGLE_DEADBAND);
+  ik_streaming_linear_speed_ = nh.param<double>("ik_streaming_linear_speed", IK_STREAMING_LINEAR_SPEED);
+  ik_streaming_angular_speed_ = nh.param<double>("ik_streaming_angular_speed", IK_STREAMING_ANGULAR_SPEED);
   send_des_joint_msg_pub_ = nh.advertise<thormang3_manipulation_module_msgs::JointPose>(
       "/robotis/manipulation/joint_pose_msg", 0);
   send_ik_msg_pub_ = nh.advertise<thormang3_manipulation_module_msgs::KinematicsPose>(
@@ -127,11 +228,24 @@ bool QNodeThor3::init()
       "/robotis/thormang3_foot_step_generator/walking_command", 0);
   set_walking_footsteps_pub_ = nh.advertise<thormang3_foot_step_generator::Step2DArray>(
       "/robotis/thormang3_foot_step_generator/footsteps_2d", 0);
+  append_walking_footsteps_pub_ = nh.advertise<thormang3_foot_step_generator::Step2DArray>(
+      "/robotis/thormang3_foot_step_generator/footsteps_2d_append", 0);
   set_walking_balance_pub_ = nh.advertise<std_msgs::Bool>("/robotis/thormang3_foot_step_generator/balance_command", 0);
+  command_latency_sub_ = status_nh.subscribe("/robotis/thormang3_foot_step_generator/command_latency", 10,
+                                             &QNodeThor3::commandLatencyCallback, this);
 
   humanoid_footstep_client_ = nh.serviceClient<humanoid_nav_msgs::PlanFootsteps>("plan_footsteps");
+  use_first_footstep_planner_ = nh.param<bool>("use_first_footstep_planner", true);
+  humanoid_first_footstep_client_ = nh.serviceClient<humanoid_nav_msgs::PlanFootsteps>(
+      "footstep_planner_first_solution/plan_footsteps");
+  humanoid_footstep_feet_client_ = nh.serviceClient<humanoid_nav_msgs::PlanFootstepsBetweenFeet>(
+      "plan_footsteps_feet");
+  footstep_execution_horizon_ = nh.param<int>("footstep_execution_horizon", 0);
   marker_pub_ = nh.advertise<visualization_msgs::MarkerArray>("/robotis/demo/foot_step_marker", 0);
-  pose_sub_ = nh.subscribe("/robotis/demo/pose", 10, &QNodeThor3::poseCallback, this);
+  std::string map_topic = nh.param<std::string>("footstep_planner_map_topic", "/projected_map");
+  // only the updates of the map are counted, so its message is subscribed without deserializing the grid
+  map_sub_ = status_nh.subscribe(map_topic, 1, &QNodeThor3::mapCallback, this);
+  pose_sub_ = sensor_nh.subscribe("/robotis/demo/pose", 10, &QNodeThor3::poseCallback, this);
 
   // Head control
   set_head_joint_angle_pub_ = nh.advertise<sensor_msgs::JointState>("/robotis/head_control/set_joint_states", 0);
@@ -142,13 +256,50 @@ bool QNodeThor3::init()
 
   // Overload - Alarm
   overload_com_pub_ = nh.advertise<std_msgs::String>("/robotis/overload/command", 0);
-  overload_status_sub_ = nh.subscribe("/robotis/overload/status", 10, &QNodeThor3::overloadStatusCallback, this);
+  overload_status_sub_ = sensor_nh.subscribe("/robotis/overload/status", 10, &QNodeThor3::overloadStatusCallback,
+                                             this);
+
+  // recorded commands are published again by their topic
+  addReplayPublisher<std_msgs::String>(move_lidar_pub_);
+  addReplayPublisher<robotis_controller_msgs::JointCtrlModule>(module_control_pub_);
+  addReplayPublisher<std_msgs::String>(module_control_preset_pub_);
+  addReplayPublisher<std_msgs::String>(init_pose_pub_);
+  addReplayPublisher<std_msgs::String>(init_ft_pub_);
+  addReplayPublisher<std_msgs::String>(send_ini_pose_msg_pub_);
+  addReplayPublisher<thormang3_manipulation_module_msgs::JointPose>(send_des_joint_msg_pub_);
+  addReplayPublisher<thormang3_manipulation_module_msgs::KinematicsPose>(send_ik_msg_pub_);
+  addReplayPublisher<sensor_msgs::JointState>(send_gripper_pub_);
+  addReplayPublisher<thormang3_foot_step_generator::FootStepCommand>(set_walking_command_pub_);
+  addReplayPublisher<thormang3_foot_step_generator::Step2DArray>(set_walking_footsteps_pub_);
+  addReplayPublisher<thormang3_foot_step_generator::Step2DArray>(append_walking_footsteps_pub_);
+  addReplayPublisher<sensor_msgs::JointState>(set_head_joint_angle_pub_);
+  addReplayPublisher<std_msgs::Int32>(motion_index_pub_);
+  addReplayPublisher<std_msgs::Int32>(motion_page_pub_);
+  addReplayPublisher<std_msgs::String>(overload_com_pub_);
 
   // Config
   std::string default_config_path = ros::package::getPath("thormang3_demo") + "/config/demo_config.yaml";
   std::string config_path = nh.param<std::string>("demo_config", default_config_path);
   parseJointNameFromYaml(config_path);
 
+  // joints read from the messages, callbacks start after this in run()
+  joint_state_layout_ = joint_index_cache_.addLayout();
+  overload_status_layout_ = joint_index_cache_.addLayout();
+  joint_module_layout_ = joint_index_cache_.addLayout();
+  head_pan_joint_index_ = joint_index_cache_.getJointIndex("head_y");
+  head_tilt_joint_index_ = joint_index_cache_.getJointIndex("head_p");
+  right_knee_joint_index_ = joint_index_cache_.getJointIndex("r_leg_kn_p");
+  left_knee_joint_index_ = joint_index_cache_.getJointIndex("l_leg_kn_p");
+
+  JointStateSample empty_sample;
+  double nan = std::numeric_limits<double>::quiet_NaN();
+  empty_sample.position.assign(joint_index_cache_.getJointSize(), nan);
+  empty_sample.velocity.assign(joint_index_cache_.getJointSize(), nan);
+  empty_sample.effort.assign(joint_index_cache_.getJointSize(), nan);
+  joint_state_buffer_.reset(empty_sample);  // samples are filled in place, without allocation
+  present_joint_module_channel_.reset(std::vector<int>(joint_index_cache_.getJointSize(), -1));
+  present_joint_modules_.assign(joint_index_cache_.getJointSize(), 0);
+
   std::string motion_path = ros::package::getPath("thormang3_demo") + "/config/motion.yaml";
   parseMotionMapFromYaml(motion_path);
 
@@ -163,13 +314,21 @@ bool QNodeThor3::init()
 
 void QNodeThor3::run()
 {
-  ros::Rate loop_rate(100);
+  // callbacks are called as soon as messages arrive and this thread sleeps until shutdown.
+  // they update the gui only through signals, which are queued to the gui thread
+  ros::AsyncSpinner sensor_spinner(1, &sensor_callback_queue_);
+  ros::AsyncSpinner status_spinner(1, &status_callback_queue_);
+  ros::AsyncSpinner default_spinner(1);  // interactive marker server
 
-  while (ros::ok())
-  {
-    ros::spinOnce();
-    loop_rate.sleep();
-  }
+  sensor_spinner.start();
+  status_spinner.start();
+  default_spinner.start();
+
+  ros::waitForShutdown();
+
+  sensor_spinner.stop();
+  status_spinner.stop();
+  default_spinner.stop();
 
   interactive_marker_server_.reset();
 
@@ -191,6 +350,7 @@ void QNodeThor3::parseJointNameFromYaml(const std::string &path)
   }
 
   // parse id_joint table
+  std::map<int, std::string> id_joint_table;
   YAML::Node id_sub_node = doc["id_joint"];
   for (YAML::iterator yaml_it = id_sub_node.begin(); yaml_it != id_sub_node.end(); ++yaml_it)
   {
@@ -200,24 +360,44 @@ void QNodeThor3::parseJointNameFromYaml(const std::string &path)
     id = yaml_it->first.as<int>();
     joint_name = yaml_it->second.as<std::string>();
 
-    id_joint_table_[id] = joint_name;
-    joint_id_table_[joint_name] = id;
+    id_joint_table[id] = joint_name;
 
     ROS_DEBUG_STREAM_COND(debug_print_, "Joint ID : " << id << " - " << joint_name);
   }
 
+  // joint index is the order of the ids, same in the cache
+  joint_registry_.setJoints(id_joint_table);
+  joint_index_cache_.setJointNames(joint_registry_.getJointNames());
+
   // parse module
   std::vector<std::string> modules = doc["module_list"].as<std::vector<std::string> >();
-
-  int module_index = 0;
-  for (std::vector<std::string>::iterator module_it = modules.begin(); module_it != modules.end(); ++module_it)
+  joint_registry_.setModules(modules);
+  using_module_list_.assign(modules.size(), false);
+
+  // parse joints of the modules
+  module_joint_list_.assign(modules.size(), std::vector<int>());
+  YAML::Node module_joint_node = doc["module_joint"];
+  for (YAML::iterator module_joint_it = module_joint_node.begin(); module_joint_it != module_joint_node.end();
+      ++module_joint_it)
   {
-    std::string module_name = *module_it;
+    std::string module_name = module_joint_it->first.as<std::string>();
+    std::vector<std::string> joint_names = module_joint_it->second.as<std::vector<std::string> >();
 
-    index_mode_table_[module_index] = module_name;
-    mode_index_table_[module_name] = module_index++;
+    int module_index = getModuleIndex(module_name);
+    if (module_index == -1)
+    {
+      ROS_WARN_STREAM("Unknown module of the module joints : " << module_name);
+      continue;
+    }
 
-    using_mode_table_[module_name] = false;
+    for (int ix = 0; ix < joint_names.size(); ix++)
+    {
+      int joint_index = joint_registry_.getJointIndex(joint_names[ix]);
+      if (joint_index == -1)
+        ROS_WARN_STREAM("Unknown joint of " << module_name << " : " << joint_names[ix]);
+      else
+        module_joint_list_[module_index].push_back(joint_index);
+    }
   }
 
   // parse module_joint preset
@@ -268,99 +448,75 @@ void QNodeThor3::parseMotionMapFromYaml(const std::string &path)
 // joint id -> joint name
 bool QNodeThor3::getJointNameFromID(const int &id, std::string &joint_name)
 {
-  std::map<int, std::string>::iterator map_it;
-
-  map_it = id_joint_table_.find(id);
-  if (map_it == id_joint_table_.end())
+  int joint_index = joint_registry_.getJointIndexFromID(id);
+  if (joint_index == -1)
     return false;
 
-  joint_name = map_it->second;
+  joint_name = joint_registry_.getJointName(joint_index);
   return true;
 }
 
 // joint name -> joint id
 bool QNodeThor3::getIDFromJointName(const std::string &joint_name, int &id)
 {
-  std::map<std::string, int>::iterator map_it;
-
-  map_it = joint_id_table_.find(joint_name);
-  if (map_it == joint_id_table_.end())
+  int joint_index = joint_registry_.getJointIndex(joint_name);
+  if (joint_index == -1)
     return false;
 
-  id = map_it->second;
+  id = joint_registry_.getJointID(joint_index);
   return true;
 }
 
-// map index -> joint id & joint name
+// joint index -> joint id & joint name
 bool QNodeThor3::getIDJointNameFromIndex(const int &index, int &id, std::string &joint_name)
 {
-  std::map<int, std::string>::iterator map_it;
-
-  int count = 0;
-  for (map_it = id_joint_table_.begin(); map_it != id_joint_table_.end(); ++map_it, count++)
-  {
-    if (index == count)
-    {
-      id = map_it->first;
-      joint_name = map_it->second;
-      return true;
-    }
-  }
+  if (index < 0 || index >= joint_registry_.getJointSize())
+    return false;
 
-  return false;
+  id = joint_registry_.getJointID(index);
+  joint_name = joint_registry_.getJointName(index);
+  return true;
 }
 
 // mode(module) index -> mode(module) name
 std::string QNodeThor3::getModuleName(const int &index)
 {
-  std::string mode = "";
-  std::map<int, std::string>::iterator map_it = index_mode_table_.find(index);
-
-  if (map_it != index_mode_table_.end())
-    mode = map_it->second;
+  if (index < 0 || index >= joint_registry_.getModuleSize())
+    return "";
 
-  return mode;
+  return joint_registry_.getModuleName(index);
 }
 
 // mode(module) name -> mode(module) index, fail to find out :-1
 int QNodeThor3::getModuleIndex(const std::string &mode_name)
 {
-  int mode_index = -1;
-  std::map<std::string, int>::iterator map_it = mode_index_table_.find(mode_name);
-
-  if (map_it != mode_index_table_.end())
-    mode_index = map_it->second;
-
-  return mode_index;
+  return joint_registry_.getModuleIndex(mode_name);
 }
 
 // number of mode(module)s
 int QNodeThor3::getModuleTableSize()
 {
-  return index_mode_table_.size();
+  return joint_registry_.getModuleSize();
 }
 
 // number of joints
 int QNodeThor3::getJointTableSize()
 {
-  return id_joint_table_.size();
+  return joint_registry_.getJointSize();
 }
 
 void QNodeThor3::clearUsingModule()
 {
-  for (std::map<std::string, bool>::iterator map_it = using_mode_table_.begin(); map_it != using_mode_table_.end();
-      ++map_it)
-    map_it->second = false;
+  using_module_list_.assign(using_module_list_.size(), false);
 }
 
 bool QNodeThor3::isUsingModule(const std::string &module_name)
 {
-  std::map<std::string, bool>::iterator map_it = using_mode_table_.find(module_name);
-
-  if (map_it == using_mode_table_.end())
+  int module_index = getModuleIndex(module_name);
+  if (module_index == -1)
     return false;
 
-  return map_it->second;
+  return using_module_list_[module_index];
 }
 
 void QNodeThor3::setCurrentControlUI(int mode)
@@ -376,7 +532,7 @@ void QNodeThor3::moveInitPose()
   std_msgs::String init_msg;
   init_msg.data = "ini_pose";
 
-  init_pose_pub_.publish(init_msg);
+  publishCommand(init_pose_pub_, init_msg);
 
   log(Info, "Go to robot initial pose.");
 }
@@ -386,7 +542,7 @@ void QNodeThor3::initFTCommand(std::string command)
   std_msgs::String ft_msg;
   ft_msg.data = command;
 
-  init_ft_pub_.publish(ft_msg);
+  publishCommand(init_ft_pub_, ft_msg);
 }
 
 // move head to assemble 3d lidar(pointcloud)
@@ -395,149 +551,320 @@ void QNodeThor3::assembleLidar()
   std_msgs::String lidar_msg;
   lidar_msg.data = "start";
 
-  move_lidar_pub_.publish(lidar_msg);
+  publishCommand(move_lidar_pub_, lidar_msg);
   log(Info, "Publish move_lidar topic");
 }
 
 // enable mode(module)
 void QNodeThor3::enableControlModule(const std::string &mode)
 {
-  std_msgs::String msg;
-  msg.data = mode;
+  enableControlModules(std::vector<std::string>(1, mode));
+}
+
+// enable mode(module) and run the action when the joints are set to it
+void QNodeThor3::enableControlModule(const std::string &mode, const DemoAction &action_after_enabled)
+{
+  enableControlModules(std::vector<std::string>(1, mode), action_after_enabled);
+}
 
-  module_control_preset_pub_.publish(msg);
+// enable mode(module)s in one message and run the action when the robot reports them.
+// a later module of the list takes the joints of an earlier one
+void QNodeThor3::enableControlModules(const std::vector<std::string> &modes, const DemoAction &action_after_enabled)
+{
+  std::vector<int> joint_modules(joint_registry_.getJointSize(), -1);
+  bool has_module_joints = true;
 
   std::stringstream ss;
-  ss << "Set Mode : " << mode;
+  ss << "Set Mode :";
+
+  for (int ix = 0; ix < modes.size(); ix++)
+  {
+    ss << " " << modes[ix];
+
+    // the walking module starts with its own parameters
+    if (modes[ix] == "walking_module")
+    {
+      is_balance_param_sent_ = false;
+      is_joint_feedback_gain_sent_ = false;
+    }
+
+    int module_index = getModuleIndex(modes[ix]);
+    if (module_index == -1 || module_joint_list_[module_index].empty() == true)
+    {
+      has_module_joints = false;
+      continue;
+    }
+
+    const std::vector<int> &module_joints = module_joint_list_[module_index];
+    for (int joint_ix = 0; joint_ix < module_joints.size(); joint_ix++)
+      joint_modules[module_joints[joint_ix]] = module_index;
+  }
+
   log(Info, ss.str());
+
+  if (has_module_joints == true)
+  {
+    setJointControlModules(joint_modules, action_after_enabled);
+    return;
+  }
+
+  // joints of a module are not known, the presets of the robot are enabled one by one
+  for (int ix = 0; ix < modes.size(); ix++)
+  {
+    std_msgs::String msg;
+    msg.data = modes[ix];
+
+    publishCommand(module_control_preset_pub_, msg);
+  }
+
+  if (action_after_enabled)
+  {
+    ModuleAction module_action;
+    module_action.module_name_list = modes;
+    module_action.action = action_after_enabled;
+    addModuleAction(module_action);
+  }
 }
 
-// get current mode(module) of joints
-void QNodeThor3::getJointControlModule()
+// set the mode(module) of the joints in one message, module index by joint index, -1 : not changed
+void QNodeThor3::setJointControlModules(const std::vector<int> &joint_modules, const DemoAction &action_after_set)
 {
-  robotis_controller_msgs::GetJointModule get_joint;
-  std::map<std::string, int> service_map;
+  robotis_controller_msgs::JointCtrlModule msg;
 
-  // get_joint.request
-  std::map<int, std::string>::iterator map_it;
-  int index = 0;
-  for (map_it = id_joint_table_.begin(); map_it != id_joint_table_.end(); ++map_it, index++)
+  for (int joint_index = 0; joint_index < joint_modules.size() && joint_index < joint_registry_.getJointSize();
+      joint_index++)
   {
-    get_joint.request.joint_name.push_back(map_it->second);
-    service_map[map_it->second] = index;
+    std::string module_name = getModuleName(joint_modules[joint_index]);
+    if (module_name == "")
+      continue;
+
+    msg.joint_name.push_back(joint_registry_.getJointName(joint_index));
+    msg.module_name.push_back(module_name);
   }
 
-  if (get_module_control_client_.call(get_joint))
+  if (msg.joint_name.empty() == false)
+    publishCommand(module_control_pub_, msg);
+
+  if (action_after_set)
   {
-    // get_joint.response
-    std::vector<int> modules;
-    modules.resize(getJointTableSize());
+    ModuleAction module_action;
+    module_action.joint_module_list = joint_modules;
+    module_action.action = action_after_set;
+    addModuleAction(module_action);
+  }
+}
 
-    // clear current using modules
-    clearUsingModule();
+void QNodeThor3::addModuleAction(const ModuleAction &module_action)
+{
+  ModuleAction deadline_action = module_action;
+  deadline_action.deadline = ros::WallTime::now() + ros::WallDuration(MODULE_SWITCH_TIMEOUT);
+  module_action_list_.push_back(deadline_action);
 
-    for (int ix = 0; ix < get_joint.response.joint_name.size(); ix++)
-    {
-      std::string joint_name = get_joint.response.joint_name[ix];
-      std::string module_name = get_joint.response.module_name[ix];
+  // the deadlines are checked by the timer, the modules by the reports of the robot
+  if (module_action_timer_.isActive() == false)
+    module_action_timer_.start(MODULE_ACTION_CHECK_INTERVAL_MS);
+}
 
-      std::map<std::string, int>::iterator service_iter = service_map.find(joint_name);
-      if (service_iter == service_map.end())
-        continue;
+bool QNodeThor3::isModuleActionReady(const ModuleAction &module_action)
+{
+  for (int ix = 0; ix < module_action.module_name_list.size(); ix++)
+  {
+    if (isUsingModule(module_action.module_name_list[ix]) == false)
+      return false;
+  }
 
-      index = service_iter->second;
+  for (int joint_index = 0; joint_index < module_action.joint_module_list.size(); joint_index++)
+  {
+    int module_index = module_action.joint_module_list[joint_index];
+    if (module_index != -1 && (joint_index >= present_joint_modules_.size()
+        || present_joint_modules_[joint_index] != module_index))
+      return false;
+  }
 
-      service_iter = mode_index_table_.find(module_name);
-      if (service_iter == mode_index_table_.end())
-        continue;
+  return true;
+}
 
-      ROS_DEBUG_STREAM_COND(debug_print_, "joint[" << ix << "] : " << service_iter->second);
+void QNodeThor3::runModuleActions()
+{
+  ros::WallTime now = ros::WallTime::now();
+  std::vector<DemoAction> ready_action_list;
 
-      modules.at(index) = service_iter->second;
+  std::vector<ModuleAction>::iterator action_it = module_action_list_.begin();
+  while (action_it != module_action_list_.end())
+  {
+    if (isModuleActionReady(*action_it) == false)
+    {
+      if (action_it->deadline > now)
+      {
+        ++action_it;
+        continue;
+      }
 
-      std::map<std::string, bool>::iterator module_iter = using_mode_table_.find(module_name);
-      if (module_iter != using_mode_table_.end())
-        module_iter->second = true;
+      // go on as before, the module may be set to some of the joints only
+      log(Warn, "Modules are not reported to be set");
     }
 
-    // update ui
-    Q_EMIT updatePresentJointControlModules(modules);
-    log(Info, "Get current Mode");
+    ready_action_list.push_back(action_it->action);
+    action_it = module_action_list_.erase(action_it);
   }
-  else
-    log(Error, "Fail to get current joint control module.");
+
+  if (module_action_list_.empty() == true)
+    module_action_timer_.stop();
+
+  // an action can enable another module
+  for (int ix = 0; ix < ready_action_list.size(); ix++)
+    ready_action_list[ix]();
 }
 
-void QNodeThor3::refreshCurrentJointControlCallback(const robotis_controller_msgs::JointCtrlModule::ConstPtr &msg)
+// get current mode(module) of joints
+void QNodeThor3::getJointControlModule()
 {
-  ROS_INFO("set current joint module");
+  boost::shared_ptr<robotis_controller_msgs::GetJointModule> get_joint(
+      new robotis_controller_msgs::GetJointModule);
 
-  std::vector<int> modules;
-  modules.resize(getJointTableSize());
+  // joints are requested in the order of the joint index
+  get_joint->request.joint_name = joint_registry_.getJointNames();
 
-  std::map<std::string, int> joint_module;
+  service_request_pool_.requestService("get current joint control module", SERVICE_TIMEOUT,
+                                       get_module_control_client_, get_joint,
+                                       boost::bind(&QNodeThor3::applyJointControlModule, this, get_joint));
+}
 
-  // clear current using modules
-  clearUsingModule();
+void QNodeThor3::applyJointControlModule(boost::shared_ptr<robotis_controller_msgs::GetJointModule> get_joint)
+{
+  // get_joint.response
+  std::vector<int> joint_modules(joint_registry_.getJointSize(), -1);
 
-  for (int ix = 0; ix < msg->joint_name.size(); ix++)
+  for (int ix = 0; ix < get_joint->response.joint_name.size() && ix < get_joint->response.module_name.size(); ix++)
   {
-    std::string joint_name = msg->joint_name[ix];
-    std::string module_name = msg->module_name[ix];
+    const std::string &joint_name = get_joint->response.joint_name[ix];
 
-    joint_module[joint_name] = getModuleIndex(module_name);
+    // the response is in the order of the request
+    int joint_index = ix;
+    if (ix >= joint_modules.size() || joint_registry_.getJointName(ix) != joint_name)
+      joint_index = joint_registry_.getJointIndex(joint_name);
+    if (joint_index == -1)
+      continue;
 
-    std::map<std::string, bool>::iterator module_iter = using_mode_table_.find(module_name);
-    if (module_iter != using_mode_table_.end())
-      module_iter->second = true;
+    joint_modules[joint_index] = getModuleIndex(get_joint->response.module_name[ix]);
   }
 
-  for (int ix = 0; ix < getJointTableSize(); ix++)
+  applyPresentJointModules(joint_modules);
+  log(Info, "Get current Mode");
+}
+
+// the modules are applied on the gui thread, the actions waiting for them are run
+void QNodeThor3::updatePresentJointModules()
+{
+  const std::vector<int> *joint_modules = present_joint_module_channel_.takeLatest();
+  if (joint_modules != NULL)
   {
-    int id = 0;
-    std::string joint_name = "";
+    applyPresentJointModules(*joint_modules);
+    log(Info, "Applied Mode", "Manager");
+  }
 
-    if (getIDJointNameFromIndex(ix, id, joint_name) == false)
-      continue;
+  runModuleActions();
+}
 
-    std::map<std::string, int>::iterator module_iter = joint_module.find(joint_name);
-    if (module_iter == joint_module.end())
-      continue;
+void QNodeThor3::applyPresentJointModules(const std::vector<int> &joint_modules)
+{
+  // a joint of an unknown module keeps the last one
+  for (int joint_index = 0; joint_index < joint_modules.size() && joint_index < present_joint_modules_.size();
+      joint_index++)
+  {
+    if (joint_modules[joint_index] != -1)
+      present_joint_modules_[joint_index] = joint_modules[joint_index];
+  }
+
+  // clear current using modules
+  clearUsingModule();
 
-    ROS_DEBUG_STREAM_COND(debug_print_, "joint[" << ix << "] : " << module_iter->second);
-    modules.at(ix) = module_iter->second;
+  for (int joint_index = 0; joint_index < present_joint_modules_.size(); joint_index++)
+  {
+    ROS_DEBUG_STREAM_COND(debug_print_, "joint[" << joint_index << "] : " << present_joint_modules_[joint_index]);
+
+    if (present_joint_modules_[joint_index] >= 0 && present_joint_modules_[joint_index] < using_module_list_.size())
+      using_module_list_[present_joint_modules_[joint_index]] = true;
   }
 
   // update ui
-  Q_EMIT updatePresentJointControlModules(modules);
+  Q_EMIT updatePresentJointControlModules(present_joint_modules_);
+}
+
+void QNodeThor3::refreshCurrentJointControlCallback(const robotis_controller_msgs::JointCtrlModule::ConstPtr &msg)
+{
+  // filled in place without allocation, the modules are applied and logged on the gui thread
+  std::vector<int> &joint_modules = present_joint_module_channel_.getWriteValue();
+
+  joint_index_cache_.updateLayout(joint_module_layout_, msg->joint_name);
+  for (int joint_index = 0; joint_index < joint_modules.size(); joint_index++)
+  {
+    int msg_index = joint_index_cache_.getMsgIndex(joint_module_layout_, joint_index);
 
-  log(Info, "Applied Mode", "Manager");
+    if (msg_index == -1 || msg_index >= msg->module_name.size())
+      joint_modules[joint_index] = -1;
+    else
+      joint_modules[joint_index] = getModuleIndex(msg->module_name[msg_index]);
+  }
+
+  present_joint_module_channel_.publish();
+  Q_EMIT controlModuleUpdated();
 }
 
 void QNodeThor3::updateHeadJointStatesCallback(const sensor_msgs::JointState::ConstPtr &msg)
 {
-  double head_pan, head_tilt;
+  // joint states come at the rate of the controller, the gui gets them decimated
+  ros::WallTime now = ros::WallTime::now();
+  if ((now - last_joint_state_sample_time_).toSec() < JOINT_STATE_SAMPLE_PERIOD)
+    return;
+  last_joint_state_sample_time_ = now;
+
+  joint_index_cache_.updateLayout(joint_state_layout_, msg->name);
+  updateJointStateBuffer(msg);
+
+  double head_pan = 0.0, head_tilt = 0.0;
   int count_getting_joint = 0;
 
-  for (int ix = 0; ix < msg->name.size(); ix++)
+  int pan_index = joint_index_cache_.getMsgIndex(joint_state_layout_, head_pan_joint_index_);
+  if (pan_index != -1 && pan_index < msg->position.size())
   {
-    if (msg->name[ix] == "head_y")
-    {
-      head_pan = -msg->position[ix];
-      count_getting_joint += 1;
-    }
-    else if (msg->name[ix] == "head_p")
-    {
-      head_tilt = -msg->position[ix];
-      count_getting_joint += 1;
-    }
+    head_pan = -msg->position[pan_index];
+    count_getting_joint += 1;
+  }
 
-    if (count_getting_joint == 2)
-      break;
+  int tilt_index = joint_index_cache_.getMsgIndex(joint_state_layout_, head_tilt_joint_index_);
+  if (tilt_index != -1 && tilt_index < msg->position.size())
+  {
+    head_tilt = -msg->position[tilt_index];
+    count_getting_joint += 1;
   }
 
   if (count_getting_joint > 0)
-    Q_EMIT updateHeadJointsAngle(head_pan, head_tilt);
+  {
+    HeadJointsAngle angle;
+    angle.pan = head_pan;
+    angle.tilt = head_tilt;
+    head_joints_angle_channel_.push(angle);
+  }
+}
+
+void QNodeThor3::updateJointStateBuffer(const sensor_msgs::JointState::ConstPtr &msg)
+{
+  JointStateSample &sample = joint_state_buffer_.getWriteValue();
+  double nan = std::numeric_limits<double>::quiet_NaN();
+
+  sample.stamp = msg->header.stamp;
+  for (int joint_index = 0; joint_index < sample.position.size(); joint_index++)
+  {
+    int msg_index = joint_index_cache_.getMsgIndex(joint_state_layout_, joint_index);
+    bool in_msg = (msg_index != -1);
+
+    sample.position[joint_index] = (in_msg && msg_index < msg->position.size()) ? msg->position[msg_index] : nan;
+    sample.velocity[joint_index] = (in_msg && msg_index < msg->velocity.size()) ? msg->velocity[msg_index] : nan;
+    sample.effort[joint_index] = (in_msg && msg_index < msg->effort.size()) ? msg->effort[msg_index] : nan;
+  }
+
+  joint_state_buffer_.publish();
 }
 
 void QNodeThor3::initFTFootCallback(const thormang3_feet_ft_module_msgs::BothWrench::ConstPtr &msg)
@@ -560,20 +887,20 @@ void QNodeThor3::setHeadJoint(double pan, double tilt)
   head_angle_msg.position.push_back(-pan);
   head_angle_msg.position.push_back(-tilt);
 
-  set_head_joint_angle_pub_.publish(head_angle_msg);
+  publishCommand(set_head_joint_angle_pub_, head_angle_msg);
 }
 
 // Manipulation
 void QNodeThor3::sendInitPoseMsg(std_msgs::String msg)
 {
-  send_ini_pose_msg_pub_.publish(msg);
+  publishCommand(send_ini_pose_msg_pub_, msg);
 
   log(Info, "Send Ini. Pose");
 }
 
 void QNodeThor3::sendDestJointMsg(thormang3_manipulation_module_msgs::JointPose msg)
 {
-  send_des_joint_msg_pub_.publish(msg);
+  publishCommand(send_des_joint_msg_pub_, msg);
 
   log(Info, "Set Des. Joint Vale");
 
@@ -586,7 +913,7 @@ void QNodeThor3::sendDestJointMsg(thormang3_manipulation_module_msgs::JointPose
 
 void QNodeThor3::sendIkMsg(thormang3_manipulation_module_msgs::KinematicsPose msg)
 {
-  send_ik_msg_pub_.publish(msg);
+  publishCommand(send_ik_msg_pub_, msg);
 
   log(Info, "Solve Inverse Kinematics");
   log(Info, "Set Des. End Effector's Pose : ");
@@ -602,18 +929,118 @@ void QNodeThor3::sendIkMsg(thormang3_manipulation_module_msgs::KinematicsPose ms
   log(Info, log_msgs.str());
 }
 
+// ik targets are sent at the streaming rate until stopped
+void QNodeThor3::startIkStreaming()
+{
+  if (ik_streaming_rate_ <= 0.0)
+  {
+    log(Error, "IK streaming rate should be positive");
+    return;
+  }
+
+  is_ik_streaming_ = true;
+  has_ik_streaming_target_ = false;
+  has_sent_ik_streaming_pose_ = false;
+
+  ik_streaming_timer_.start(static_cast<int>(1000.0 / ik_streaming_rate_));
+
+  std::stringstream ss;
+  ss << "Start IK streaming [" << ik_streaming_rate_ << " Hz]";
+  log(Info, ss.str());
+}
+
+void QNodeThor3::stopIkStreaming()
+{
+  if (is_ik_streaming_ == false)
+    return;
+
+  is_ik_streaming_ = false;
+  ik_streaming_timer_.stop();
+
+  log(Info, "Stop IK streaming");
+}
+
+// latest target from the operator, the targets between the ticks are dropped
+void QNodeThor3::setIkStreamingTarget(const thormang3_manipulation_module_msgs::KinematicsPose &target)
+{
+  if (is_ik_streaming_ == false)
+    return;
+
+  // the pose sent to the other group is not the start of this one
+  if (has_ik_streaming_target_ == true && ik_streaming_target_.name != target.name)
+    has_sent_ik_streaming_pose_ = false;
+
+  ik_streaming_target_ = target;
+  has_ik_streaming_target_ = true;
+}
+
+void QNodeThor3::streamIkTarget()
+{
+  if (is_ik_streaming_ == false || has_ik_streaming_target_ == false)
+    return;
+
+  Eigen::Vector3d target_position, sent_position;
+  Eigen::Quaterniond target_orientation, sent_orientation;
+  tf::pointMsgToEigen(ik_streaming_target_.pose.position, target_position);
+  tf::quaternionMsgToEigen(ik_streaming_target_.pose.orientation, target_orientation);
+  target_orientation.normalize();
+
+  thormang3_manipulation_module_msgs::KinematicsPose msg = ik_streaming_target_;
+
+  // the first target is sent as it is
+  if (has_sent_ik_streaming_pose_ == false)
+  {
+    tf::quaternionEigenToMsg(target_orientation, msg.pose.orientation);
+  }
+  else
+  {
+    tf::pointMsgToEigen(sent_ik_streaming_pose_.position, sent_position);
+    tf::quaternionMsgToEigen(sent_ik_streaming_pose_.orientation, sent_orientation);
+
+    Eigen::Vector3d position_diff = target_position - sent_position;
+    double position_distance = position_diff.norm();
+    double angle_distance = sent_orientation.angularDistance(target_orientation);
+
+    // deadband
+    if (position_distance < ik_streaming_position_deadband_ && angle_distance < ik_streaming_angle_deadband_)
+      return;
+
+    // interpolated toward the target within the speed limits of a tick
+    double period = 1.0 / ik_streaming_rate_;
+    double max_position_step = ik_streaming_linear_speed_ * period;
+    double max_angle_step = ik_streaming_angular_speed_ * period;
+
+    Eigen::Vector3d next_position = target_position;
+    if (position_distance > max_position_step)
+      next_position = sent_position + position_diff * (max_position_step / position_distance);
+
+    Eigen::Quaterniond next_orientation = target_orientation;
+    if (angle_distance > max_angle_step)
+      next_orientation = sent_orientation.slerp(max_angle_step / angle_distance, target_orientation);
+
+    tf::pointEigenToMsg(next_position, msg.pose.position);
+    tf::quaternionEigenToMsg(next_orientation, msg.pose.orientation);
+  }
+
+  publishCommand(send_ik_msg_pub_, msg);
+
+  sent_ik_streaming_pose_ = msg.pose;
+  has_sent_ik_streaming_pose_ = true;
+}
+
 void QNodeThor3::sendGripperPosition(sensor_msgs::JointState msg)
 {
   // publish gripper angle
-  send_gripper_pub_.publish(msg);
+  publishCommand(send_gripper_pub_, msg);
 }
 
 void QNodeThor3::getJointPose(std::string joint_name)
 {
-  thormang3_manipulation_module_msgs::GetJointPose get_joint_pose;
+  boost::shared_ptr<thormang3_manipulation_module_msgs::GetJointPose> get_joint_pose(
+      new thormang3_manipulation_module_msgs::GetJointPose);
 
   // requeset
-  get_joint_pose.request.joint_name = joint_name;
+  get_joint_pose->request.joint_name = joint_name;
 
   log(Info, "Get Curr. Joint Value");
 
@@ -623,31 +1050,33 @@ void QNodeThor3::getJointPose(std::string joint_name)
 
   log(Info, log_msg.str());
 
+  service_request_pool_.requestService("get joint pose", SERVICE_TIMEOUT, get_joint_pose_client_, get_joint_pose,
+                                       boost::bind(&QNodeThor3::applyJointPose, this, get_joint_pose));
+}
+
+void QNodeThor3::applyJointPose(boost::shared_ptr<thormang3_manipulation_module_msgs::GetJointPose> get_joint_pose)
+{
   //response
-  if (get_joint_pose_client_.call(get_joint_pose))
-  {
-    double joint_value = get_joint_pose.response.joint_value;
+  double joint_value = get_joint_pose->response.joint_value;
 
-    log(Info, "Joint Curr. Value");
+  log(Info, "Joint Curr. Value");
 
-    std::stringstream log_msg;
+  std::stringstream log_msg;
 
-    log_msg << " \n " << "curr. value : " << joint_value << " \n ";
+  log_msg << " \n " << "curr. value : " << joint_value << " \n ";
 
-    log(Info, log_msg.str());
+  log(Info, log_msg.str());
 
-    Q_EMIT updateCurrJoint(joint_value);
-  }
-  else
-    log(Error, "fail to get joint pose.");
+  Q_EMIT updateCurrJoint(joint_value);
 }
 
 void QNodeThor3::getKinematicsPose(std::string group_name)
 {
-  thormang3_manipulation_module_msgs::GetKinematicsPose get_kinematics_pose;
+  boost::shared_ptr<thormang3_manipulation_module_msgs::GetKinematicsPose> get_kinematics_pose(
+      new thormang3_manipulation_module_msgs::GetKinematicsPose);
 
   //request
-  get_kinematics_pose.request.group_name = group_name;
+  get_kinematics_pose->request.group_name = group_name;
 
   log(Info, "Solve Forward Kinematics");
 
@@ -659,46 +1088,56 @@ void QNodeThor3::getKinematicsPose(std::string group_name)
 
   log(Info, log_msg.str());
 
+  service_request_pool_.requestService("get kinematics pose", SERVICE_TIMEOUT, get_kinematics_pose_client_,
+                                       get_kinematics_pose,
+                                       boost::bind(&QNodeThor3::applyKinematicsPose, this, get_kinematics_pose));
+}
+
+void QNodeThor3::applyKinematicsPose(
+    boost::shared_ptr<thormang3_manipulation_module_msgs::GetKinematicsPose> get_kinematics_pose)
+{
   //response
-  if (get_kinematics_pose_client_.call(get_kinematics_pose))
-  {
-    double pos_x = get_kinematics_pose.response.group_pose.position.x;
-    double pos_y = get_kinematics_pose.response.group_pose.position.y;
-    double pos_z = get_kinematics_pose.response.group_pose.position.z;
+  double pos_x = get_kinematics_pose->response.group_pose.position.x;
+  double pos_y = get_kinematics_pose->response.group_pose.position.y;
+  double pos_z = get_kinematics_pose->response.group_pose.position.z;
 
-    double ori_x = get_kinematics_pose.response.group_pose.orientation.x;
-    double ori_y = get_kinematics_pose.response.group_pose.orientation.y;
-    double ori_z = get_kinematics_pose.response.group_pose.orientation.z;
-    double ori_w = get_kinematics_pose.response.group_pose.orientation.w;
+  double ori_x = get_kinematics_pose->response.group_pose.orientation.x;
+  double ori_y = get_kinematics_pose->response.group_pose.orientation.y;
+  double ori_z = get_kinematics_pose->response.group_pose.orientation.z;
+  double ori_w = get_kinematics_pose->response.group_pose.orientation.w;
 
-    log(Info, "End Effector Curr. Pose : ");
+  log(Info, "End Effector Curr. Pose : ");
 
-    std::stringstream log_msg;
+  std::stringstream log_msg;
 
-    log_msg << " \n " << "curr. pos. x : " << pos_x << " \n " << "curr. pos. y : " << pos_y << " \n "
-            << "curr. pos. z : " << pos_z << " \n " << "curr. ori. w : " << ori_w << " \n " << "curr. ori. x : "
-            << ori_x << " \n " << "curr. ori. y : " << ori_y << " \n " << "curr. ori. z : " << ori_z << " \n ";
+  log_msg << " \n " << "curr. pos. x : " << pos_x << " \n " << "curr. pos. y : " << pos_y << " \n "
+          << "curr. pos. z : " << pos_z << " \n " << "curr. ori. w : " << ori_w << " \n " << "curr. ori. x : "
+          << ori_x << " \n " << "curr. ori. y : " << ori_y << " \n " << "curr. ori. z : " << ori_z << " \n ";
 
-    log(Info, log_msg.str());
+  log(Info, log_msg.str());
 
-    Q_EMIT updateCurrPos(pos_x, pos_y, pos_z);
-    Q_EMIT updateCurrOri(ori_x, ori_y, ori_z, ori_w);
-  }
-  else
-    log(Error, "fail to get kinematics pose.");
+  Q_EMIT updateCurrPos(pos_x, pos_y, pos_z);
+  Q_EMIT updateCurrOri(ori_x, ori_y, ori_z, ori_w);
 }
 
 void QNodeThor3::getKinematicsPoseCallback(const geometry_msgs::Pose::ConstPtr &msg)
 {
   double z_offset = 0.801;
-  Q_EMIT updateCurrPos(msg->position.x, msg->position.y, msg->position.z + z_offset);
-  Q_EMIT updateCurrOri(msg->orientation.x, msg->orientation.y, msg->orientation.z, msg->orientation.w);
+  geometry_msgs::Pose &curr_pose = curr_pose_channel_.getWriteValue();
+  curr_pose = *msg;
+  curr_pose.position.z += z_offset;
+  curr_pose_channel_.publish();
 }
 
 // Walking
 void QNodeThor3::setWalkingCommand(thormang3_foot_step_generator::FootStepCommand msg)
 {
-  set_walking_command_pub_.publish(msg);
+  msg.command_id = ++last_walking_command_id_;
+  msg.stamp = ros::Time::now();
+  publishCommand(set_walking_command_pub_, msg);
+
+  // the start of the walking is caused by this one from now
+  is_walking_start_pending_ = false;
 
   std::stringstream ss;
   ss << "Set Walking Command : " << msg.command << std::endl;
@@ -761,13 +1200,38 @@ void QNodeThor3::setWalkingFootsteps()
     return;
   }
 
+  // a short plan is walked at once, and a plan without a step of each foot in the horizon for the stance
+  int horizon = footstep_execution_horizon_;
+  if (horizon <= 0 || preview_foot_steps_.size() <= horizon + 2
+      || std::find(preview_foot_types_.begin(), preview_foot_types_.begin() + horizon,
+                   humanoid_nav_msgs::StepTarget::left) == preview_foot_types_.begin() + horizon
+      || std::find(preview_foot_types_.begin(), preview_foot_types_.begin() + horizon,
+                   humanoid_nav_msgs::StepTarget::right) == preview_foot_types_.begin() + horizon)
+    horizon = preview_foot_steps_.size();
+
+  // the first steps end the walking, so the robot stops if the rest is late.
+  // the rest replaces their ending step while it is not reserved
+  publishCommand(set_walking_footsteps_pub_, makeStep2DArray(preview_foot_steps_, preview_foot_types_, 0, horizon));
+
+  log(Info, "Set command to walk using footsteps");
+
+  if (horizon < preview_foot_steps_.size())
+    planRestFootsteps(horizon);
+
+  clearFootsteps();
+}
+
+thormang3_foot_step_generator::Step2DArray QNodeThor3::makeStep2DArray(
+    const std::vector<geometry_msgs::Pose2D> &foot_steps, const std::vector<int> &foot_types, int begin_index,
+    int end_index)
+{
   thormang3_foot_step_generator::Step2DArray footsteps;
 
-  for (int ix = 0; ix < preview_foot_steps_.size(); ix++)
+  for (int ix = begin_index; ix < end_index; ix++)
   {
     thormang3_foot_step_generator::Step2D step;
 
-    int type = preview_foot_types_[ix];
+    int type = foot_types[ix];
     if (type == humanoid_nav_msgs::StepTarget::right)
       step.moving_foot = thormang3_foot_step_generator::Step2D::RIGHT_FOOT_SWING;
     else if (type == humanoid_nav_msgs::StepTarget::left)
@@ -775,120 +1239,365 @@ void QNodeThor3::setWalkingFootsteps()
     else
       step.moving_foot = thormang3_foot_step_generator::Step2D::STANDING;
 
-    step.step2d = preview_foot_steps_[ix];
+    step.step2d = foot_steps[ix];
 
     footsteps.footsteps_2d.push_back(step);
   }
 
-  set_walking_footsteps_pub_.publish(footsteps);
-
-  log(Info, "Set command to walk using footsteps");
+  // published as soon as it is made, the start of the walking is caused by it from now
+  footsteps.command_id = ++last_walking_command_id_;
+  footsteps.stamp = ros::Time::now();
+  is_walking_start_pending_ = false;
 
-  clearFootsteps();
+  return footsteps;
 }
 
-void QNodeThor3::clearFootsteps()
+// the rest of the preview after the horizon is planned again from the stance at the horizon
+// while the robot walks the first steps, and appended to them
+void QNodeThor3::planRestFootsteps(int horizon)
 {
-  // clear foot step marker array
-  visualizePreviewFootsteps(true);
+  service_request_pool_.cancel("plan rest footsteps");
 
-  preview_foot_steps_.clear();
-  preview_foot_types_.clear();
-}
+  boost::shared_ptr<humanoid_nav_msgs::PlanFootstepsBetweenFeet> get_step(
+      new humanoid_nav_msgs::PlanFootstepsBetweenFeet);
 
-void QNodeThor3::makeFootstepUsingPlanner()
-{
-  makeFootstepUsingPlanner(pose_from_ui_);
-}
+  // stance : the last step of each foot in the horizon, goal : the last step of each foot in the plan.
+  // the horizon has a step of each foot, see setWalkingFootsteps()
+  for (int ix = 0; ix < preview_foot_steps_.size(); ix++)
+  {
+    humanoid_nav_msgs::StepTarget step;
+    step.pose = preview_foot_steps_[ix];
+    step.leg = preview_foot_types_[ix];
 
-void QNodeThor3::makeFootstepUsingPlanner(const geometry_msgs::Pose &target_foot_pose)
-{
-  //foot step service
-  humanoid_nav_msgs::PlanFootsteps get_step;
+    if (step.leg == humanoid_nav_msgs::StepTarget::left)
+    {
+      if (ix < horizon)
+        get_step->request.start_left = step;
+      get_step->request.goal_left = step;
+    }
+    else if (step.leg == humanoid_nav_msgs::StepTarget::right)
+    {
+      if (ix < horizon)
+        get_step->request.start_right = step;
+      get_step->request.goal_right = step;
+    }
+  }
 
-  geometry_msgs::Pose2D start;
-  geometry_msgs::Pose2D goal;
-  goal.x = target_foot_pose.position.x;
-  goal.y = target_foot_pose.position.y;
+  walked_foot_steps_.assign(preview_foot_steps_.begin(), preview_foot_steps_.begin() + horizon);
+  walked_foot_types_.assign(preview_foot_types_.begin(), preview_foot_types_.begin() + horizon);
+  rest_foot_steps_.assign(preview_foot_steps_.begin() + horizon, preview_foot_steps_.end());
+  rest_foot_types_.assign(preview_foot_types_.begin() + horizon, preview_foot_types_.end());
+  is_rest_footsteps_pending_ = true;
+  is_walking_finished_before_rest_ = false;
 
-  Eigen::Quaterniond goal_orientation;
-  tf::quaternionMsgToEigen(target_foot_pose.orientation, goal_orientation);
+  std::stringstream msg;
+  msg << "Walk " << horizon << " footsteps, the rest is planned again on the move";
+  log(Info, msg.str());
 
-  Eigen::Vector3d forward, f_x(1, 0, 0);
-  forward = goal_orientation.toRotationMatrix() * f_x;
-  double theta = forward.y() > 0 ? acos(forward.x()) : -acos(forward.x());
-  goal.theta = theta;
+  service_request_pool_.requestService("plan rest footsteps", FOOTSTEP_PLANNER_TIMEOUT, humanoid_footstep_feet_client_,
+                                       get_step, boost::bind(&QNodeThor3::applyRestFootsteps, this, get_step));
+}
 
-  get_step.request.start = start;
-  get_step.request.goal = goal;
+void QNodeThor3::applyRestFootsteps(boost::shared_ptr<humanoid_nav_msgs::PlanFootstepsBetweenFeet> get_step)
+{
+  if (is_rest_footsteps_pending_ == false)
+    return;
+
+  if (get_step->response.result == false)
+  {
+    log(Warn, "fail to plan the rest footsteps, the previous plan is used");
+    appendRestFootsteps(rest_foot_steps_, rest_foot_types_);
+    return;
+  }
+
+  std::vector<geometry_msgs::Pose2D> foot_steps;
+  std::vector<int> foot_types;
+  for (int ix = 0; ix < get_step->response.footsteps.size(); ix++)
+  {
+    const humanoid_nav_msgs::StepTarget &step = get_step->response.footsteps[ix];
+
+    // the plan starts with the feet of the stance, they are already there
+    if (foot_steps.size() == 0)
+    {
+      const humanoid_nav_msgs::StepTarget &stance =
+          (step.leg == humanoid_nav_msgs::StepTarget::left) ? get_step->request.start_left :
+              get_step->request.start_right;
+      if (fabs(step.pose.x - stance.pose.x) < 0.001 && fabs(step.pose.y - stance.pose.y) < 0.001
+          && fabs(step.pose.theta - stance.pose.theta) < 0.001)
+        continue;
+    }
+
+    foot_steps.push_back(step.pose);
+    foot_types.push_back(step.leg);
+  }
+
+  appendRestFootsteps(foot_steps, foot_types);
+}
+
+void QNodeThor3::appendRestFootsteps(const std::vector<geometry_msgs::Pose2D> &foot_steps,
+                                     const std::vector<int> &foot_types)
+{
+  is_rest_footsteps_pending_ = false;
+
+  if (is_walking_finished_before_rest_ == true)
+  {
+    walkRestFootstepsFromStance(foot_steps, foot_types);
+    return;
+  }
+
+  // the generator replaces the steps after the reserved ones, the first steps are sent again with the rest
+  // and the reserved ones are skipped by it
+  std::vector<geometry_msgs::Pose2D> append_foot_steps(walked_foot_steps_);
+  std::vector<int> append_foot_types(walked_foot_types_);
+  append_foot_steps.insert(append_foot_steps.end(), foot_steps.begin(), foot_steps.end());
+  append_foot_types.insert(append_foot_types.end(), foot_types.begin(), foot_types.end());
+
+  publishCommand(append_walking_footsteps_pub_,
+                 makeStep2DArray(append_foot_steps, append_foot_types, 0, append_foot_steps.size()));
+
+  std::stringstream msg;
+  msg << "Append " << foot_steps.size() << " footsteps to the walking";
+  log(Info, msg.str());
+}
+
+// the walking module starts a new walking from the stance of the robot, the rest is moved to its frame
+void QNodeThor3::walkRestFootstepsFromStance(const std::vector<geometry_msgs::Pose2D> &foot_steps,
+                                             const std::vector<int> &foot_types)
+{
+  // the last step of each foot in the first steps, see setWalkingFootsteps()
+  geometry_msgs::Pose2D stance_left, stance_right;
+  for (int ix = 0; ix < walked_foot_steps_.size(); ix++)
+  {
+    if (walked_foot_types_[ix] == humanoid_nav_msgs::StepTarget::left)
+      stance_left = walked_foot_steps_[ix];
+    else if (walked_foot_types_[ix] == humanoid_nav_msgs::StepTarget::right)
+      stance_right = walked_foot_steps_[ix];
+  }
+
+  double center_x = 0.5 * (stance_left.x + stance_right.x);
+  double center_y = 0.5 * (stance_left.y + stance_right.y);
+  double center_theta = stance_left.theta + 0.5 * remainder(stance_right.theta - stance_left.theta, 2 * M_PI);
+  double cos_theta = cos(center_theta);
+  double sin_theta = sin(center_theta);
+
+  std::vector<geometry_msgs::Pose2D> stance_foot_steps;
+  for (int ix = 0; ix < foot_steps.size(); ix++)
+  {
+    double dx = foot_steps[ix].x - center_x;
+    double dy = foot_steps[ix].y - center_y;
+
+    geometry_msgs::Pose2D foot_step;
+    foot_step.x = cos_theta * dx + sin_theta * dy;
+    foot_step.y = -sin_theta * dx + cos_theta * dy;
+    foot_step.theta = remainder(foot_steps[ix].theta - center_theta, 2 * M_PI);
+    stance_foot_steps.push_back(foot_step);
+  }
+
+  publishCommand(set_walking_footsteps_pub_, makeStep2DArray(stance_foot_steps, foot_types, 0, foot_types.size()));
+
+  std::stringstream msg;
+  msg << "The robot stopped before the rest, walk " << foot_steps.size() << " footsteps from the stance";
+  log(Info, msg.str());
+}
+
+void QNodeThor3::clearFootsteps()
+{
+  // drop the result of the planning in progress
+  service_request_pool_.cancel("plan first footsteps");
+  service_request_pool_.cancel("plan footsteps");
+
+  // clear foot step marker array
+  visualizePreviewFootsteps(true);
+
+  preview_foot_steps_.clear();
+  preview_foot_types_.clear();
+}
+
+void QNodeThor3::makeFootstepUsingPlanner()
+{
+  makeFootstepUsingPlanner(pose_from_ui_);
+}
+
+void QNodeThor3::makeFootstepUsingPlanner(const geometry_msgs::Pose &target_foot_pose)
+{
+  // a new target replaces the planning in progress
+  service_request_pool_.cancel("plan first footsteps");
+  service_request_pool_.cancel("plan footsteps");
+
+  //foot step service
+  boost::shared_ptr<humanoid_nav_msgs::PlanFootsteps> get_step(new humanoid_nav_msgs::PlanFootsteps);
+
+  geometry_msgs::Pose2D start;
+  geometry_msgs::Pose2D goal;
+  goal.x = target_foot_pose.position.x;
+  goal.y = target_foot_pose.position.y;
+
+  Eigen::Quaterniond goal_orientation;
+  tf::quaternionMsgToEigen(target_foot_pose.orientation, goal_orientation);
+
+  Eigen::Vector3d forward, f_x(1, 0, 0);
+  forward = goal_orientation.toRotationMatrix() * f_x;
+  double theta = forward.y() > 0 ? acos(forward.x()) : -acos(forward.x());
+  goal.theta = theta;
+
+  get_step->request.start = start;
+  get_step->request.goal = goal;
 
   std::stringstream call_msg;
   call_msg << "Start [" << start.x << ", " << start.y << " | " << start.theta << "]" << " , Goal [" << goal.x << ", "
            << goal.y << " | " << goal.theta << "]";
   log(Info, call_msg.str());
 
-  // clear visualization
-  visualizePreviewFootsteps(true);
+  // the shown preview is kept until the new plan arrives, then only the changed steps are published
 
   // init foot steps
   preview_foot_steps_.clear();
   preview_foot_types_.clear();
 
-  if (humanoid_footstep_client_.call(get_step))
+  // the same goal on the same map is not planned again
+  int map_version = map_version_.load(boost::memory_order_relaxed);
+  FootstepPlanCache::Plan cached_plan;
+  if (footstep_plan_cache_.find(goal, map_version, cached_plan) == true)
+  {
+    preview_foot_steps_ = cached_plan.foot_steps;
+    preview_foot_types_ = cached_plan.foot_types;
+
+    std::stringstream cache_msg;
+    cache_msg << "Use the cached footsteps : " << preview_foot_steps_.size() << " steps";
+    log(Info, cache_msg.str());
+
+    visualizePreviewFootsteps(false);
+    return;
+  }
+
+  // the first solution is shown while the planner improves the plan for its allocated time,
+  // the operator can walk with it before the final plan arrives
+  if (use_first_footstep_planner_ == true)
   {
-    if (get_step.response.result)
+    boost::shared_ptr<humanoid_nav_msgs::PlanFootsteps> get_first_step(new humanoid_nav_msgs::PlanFootsteps);
+    get_first_step->request = get_step->request;
+
+    service_request_pool_.requestService(
+        "plan first footsteps", SERVICE_TIMEOUT, humanoid_first_footstep_client_, get_first_step,
+        boost::bind(&QNodeThor3::applyFootstepsFromPlanner, this, get_first_step, map_version, false));
+  }
+
+  service_request_pool_.requestService(
+      "plan footsteps", FOOTSTEP_PLANNER_TIMEOUT, humanoid_footstep_client_, get_step,
+      boost::bind(&QNodeThor3::applyFootstepsFromPlanner, this, get_step, map_version, true));
+}
+
+void QNodeThor3::applyFootstepsFromPlanner(boost::shared_ptr<humanoid_nav_msgs::PlanFootsteps> get_step,
+                                           int map_version, bool is_final_plan)
+{
+  // the late first solution does not replace the final plan
+  if (is_final_plan == true)
+    service_request_pool_.cancel("plan first footsteps");
+
+  if (get_step->response.result)
+  {
+    preview_foot_steps_.clear();
+    preview_foot_types_.clear();
+
+    for (int ix = 0; ix < get_step->response.footsteps.size(); ix++)
     {
-      for (int ix = 0; ix < get_step.response.footsteps.size(); ix++)
+      int foot_type = get_step->response.footsteps[ix].leg;
+      geometry_msgs::Pose2D foot_pose = get_step->response.footsteps[ix].pose;
+
+      // log footsteps of the final plan
+      if (is_final_plan == true)
       {
-        // foot step log
         std::stringstream msg_stream;
-        int foot_type = get_step.response.footsteps[ix].leg;
         std::string foot = (foot_type == humanoid_nav_msgs::StepTarget::right) ? "right" : "left";
-        geometry_msgs::Pose2D foot_pose = get_step.response.footsteps[ix].pose;
-
-        // log footsteps
-        msg_stream << "Foot Step #" << ix + 1 << " [ " << foot << "] - [" << foot_pose.x << ", " << foot_pose.y << " | "
-                   << (foot_pose.theta * RADIAN2DEGREE) << "]";
+        msg_stream << "Foot Step #" << ix + 1 << " [ " << foot << "] - [" << foot_pose.x << ", " << foot_pose.y
+                   << " | " << (foot_pose.theta * RADIAN2DEGREE) << "]";
         log(Info, msg_stream.str());
-
-        preview_foot_steps_.push_back(foot_pose);
-        preview_foot_types_.push_back(foot_type);
       }
 
-      // visualize foot steps
-      visualizePreviewFootsteps(false);
+      preview_foot_steps_.push_back(foot_pose);
+      preview_foot_types_.push_back(foot_type);
+    }
+
+    if (is_final_plan == true)
+    {
+      FootstepPlanCache::Plan plan;
+      plan.foot_steps = preview_foot_steps_;
+      plan.foot_types = preview_foot_types_;
+      footstep_plan_cache_.insert(get_step->request.goal, map_version, plan);
     }
     else
     {
-      log(Info, "fail to get foot step from planner");
-      return;
+      std::stringstream msg_stream;
+      msg_stream << "First footsteps : " << preview_foot_steps_.size() << " steps, the plan is being improved";
+      log(Info, msg_stream.str());
     }
+
+    // visualize foot steps
+    visualizePreviewFootsteps(false);
   }
   else
   {
-    log(Error, "cannot call service");
-    return;
-  }
+    log(Info, "fail to get foot step from planner");
 
-  return;
+    // clear the preview of the previous plan, the first solution is kept
+    if (preview_foot_steps_.size() == 0)
+      visualizePreviewFootsteps(true);
+  }
 }
 
 void QNodeThor3::visualizePreviewFootsteps(bool clear)
 {
-  if (clear && preview_foot_steps_.size() == 0)
-    return;
+  std::vector<visualization_msgs::Marker> footstep_markers;
+  if (clear == false)
+    makeFootstepMarkers(footstep_markers);
 
   visualization_msgs::MarkerArray marker_array;
   ros::Time now = ros::Time::now();
+
+  // added or changed steps
+  for (int ix = 0; ix < footstep_markers.size(); ix++)
+  {
+    if (ix < shown_footstep_markers_.size() && isSameMessage(shown_footstep_markers_[ix], footstep_markers[ix]))
+      continue;
+
+    visualization_msgs::Marker rviz_marker = footstep_markers[ix];
+    rviz_marker.header.stamp = now;
+    marker_array.markers.push_back(rviz_marker);
+  }
+
+  // removed steps
+  for (int ix = footstep_markers.size(); ix < shown_footstep_markers_.size(); ix++)
+  {
+    visualization_msgs::Marker rviz_marker = shown_footstep_markers_[ix];
+    rviz_marker.header.stamp = now;
+    rviz_marker.action = visualization_msgs::Marker::DELETE;
+    marker_array.markers.push_back(rviz_marker);
+  }
+
+  shown_footstep_markers_.swap(footstep_markers);
+
+  if (marker_array.markers.size() == 0)
+    return;
+
+  // publish foot step marker array
+  if (clear == false)
+    log(Info, "Visualize Preview Footstep Marker Array");
+  else
+    log(Info, "Clear Visualize Preview Footstep Marker Array");
+
+  marker_pub_.publish(marker_array);
+}
+
+// marker of each preview step, the id is the index of the step
+void QNodeThor3::makeFootstepMarkers(std::vector<visualization_msgs::Marker> &footstep_markers)
+{
   visualization_msgs::Marker rviz_marker;
 
   rviz_marker.header.frame_id = "pelvis_link";
-  rviz_marker.header.stamp = now;
   rviz_marker.ns = "foot_step_marker";
 
-  rviz_marker.id = 1;
   rviz_marker.type = visualization_msgs::Marker::CUBE;
-  rviz_marker.action = (clear == false) ? visualization_msgs::Marker::ADD : visualization_msgs::Marker::DELETE;
+  rviz_marker.action = visualization_msgs::Marker::ADD;
 
   rviz_marker.scale.x = 0.216;
   rviz_marker.scale.y = 0.144;
@@ -897,103 +1606,118 @@ void QNodeThor3::visualizePreviewFootsteps(bool clear)
   double alpha = 0.7;
   double height = -0.723;
 
+  footstep_markers.resize(preview_foot_types_.size());
+
   for (int ix = preview_foot_types_.size() - 1; ix >= 0; ix--)
   {
-    // foot step marker array
-    rviz_marker.id += 10;
+    rviz_marker.id = ix + 1;
 
-    if (!clear)
-    {
-      Eigen::Vector3d marker_position(preview_foot_steps_[ix].x, preview_foot_steps_[ix].y, height);
-      Eigen::Vector3d marker_position_offset;
+    Eigen::Vector3d marker_position(preview_foot_steps_[ix].x, preview_foot_steps_[ix].y, height);
+    Eigen::Vector3d marker_position_offset;
 
-      Eigen::Vector3d toward(1, 0, 0), direction(cos(preview_foot_steps_[ix].theta), sin(preview_foot_steps_[ix].theta),
-                                                 0);
-      Eigen::Quaterniond marker_orientation(Eigen::Quaterniond::FromTwoVectors(toward, direction));
+    Eigen::Vector3d toward(1, 0, 0), direction(cos(preview_foot_steps_[ix].theta), sin(preview_foot_steps_[ix].theta),
+                                               0);
+    Eigen::Quaterniond marker_orientation(Eigen::Quaterniond::FromTwoVectors(toward, direction));
 
-      if (debug_print_)
-      {
-        std::stringstream msg;
-        msg << "Foot Step #" << ix << " [ " << preview_foot_types_[ix] << "] - [" << rviz_marker.pose.position.x << ", "
-            << rviz_marker.pose.position.y << "]";
-        log(Info, msg.str());
-      }
-      alpha *= 0.9;
+    alpha *= 0.9;
 
-      // set foot step color
-      if (preview_foot_types_[ix] == humanoid_nav_msgs::StepTarget::left)  // left
-      {
-        rviz_marker.color.r = 0.0;
-        rviz_marker.color.g = 0.0;
-        rviz_marker.color.b = 1.0;
-        rviz_marker.color.a = alpha + 0.3;
+    // set foot step color
+    if (preview_foot_types_[ix] == humanoid_nav_msgs::StepTarget::left)  // left
+    {
+      rviz_marker.color.r = 0.0;
+      rviz_marker.color.g = 0.0;
+      rviz_marker.color.b = 1.0;
+      rviz_marker.color.a = alpha + 0.3;
 
-        Eigen::Vector3d offset_y(0, 0.015, 0);
-        marker_position_offset = marker_orientation.toRotationMatrix() * offset_y;
+      Eigen::Vector3d offset_y(0, 0.015, 0);
+      marker_position_offset = marker_orientation.toRotationMatrix() * offset_y;
 
-      }
-      else if (preview_foot_types_[ix] == humanoid_nav_msgs::StepTarget::right)  //right
-      {
-        rviz_marker.color.r = 1.0;
-        rviz_marker.color.g = 0.0;
-        rviz_marker.color.b = 0.0;
-        rviz_marker.color.a = alpha + 0.3;
+    }
+    else if (preview_foot_types_[ix] == humanoid_nav_msgs::StepTarget::right)  //right
+    {
+      rviz_marker.color.r = 1.0;
+      rviz_marker.color.g = 0.0;
+      rviz_marker.color.b = 0.0;
+      rviz_marker.color.a = alpha + 0.3;
 
-        Eigen::Vector3d offset_y(0, -0.015, 0);
-        marker_position_offset = marker_orientation.toRotationMatrix() * offset_y;
-      }
+      Eigen::Vector3d offset_y(0, -0.015, 0);
+      marker_position_offset = marker_orientation.toRotationMatrix() * offset_y;
+    }
 
-      marker_position = marker_position_offset + marker_position;
+    marker_position = marker_position_offset + marker_position;
 
-      tf::pointEigenToMsg(marker_position, rviz_marker.pose.position);
-      tf::quaternionEigenToMsg(marker_orientation, rviz_marker.pose.orientation);
+    tf::pointEigenToMsg(marker_position, rviz_marker.pose.position);
+    tf::quaternionEigenToMsg(marker_orientation, rviz_marker.pose.orientation);
 
-      // apply foot x offset
+    if (debug_print_)
+    {
+      std::stringstream msg;
+      msg << "Foot Step #" << ix << " [ " << preview_foot_types_[ix] << "] - [" << rviz_marker.pose.position.x << ", "
+          << rviz_marker.pose.position.y << "]";
+      log(Info, msg.str());
     }
 
-    marker_array.markers.push_back(rviz_marker);
+    footstep_markers[ix] = rviz_marker;
   }
+}
 
-  // publish foot step marker array
-  if (clear == false)
-    log(Info, "Visualize Preview Footstep Marker Array");
+void QNodeThor3::setBalanceParameter()
+{
+  // the walking module already has it
+  if (is_balance_param_sent_ == true
+      && isSameMessage(sent_balance_param_, set_balance_param_srv_.request.balance_param))
+  {
+    ROS_INFO("[Demo]  : balance param is not changed");
+  }
   else
-    log(Info, "Clear Visualize Preview Footstep Marker Array");
+  {
+    // the request is copied, set_balance_param_srv_ can be changed for the next one
+    boost::shared_ptr<thormang3_walking_module_msgs::SetBalanceParam> set_balance_param(
+        new thormang3_walking_module_msgs::SetBalanceParam);
+    set_balance_param->request = set_balance_param_srv_.request;
+
+    sent_balance_param_ = set_balance_param_srv_.request.balance_param;
+    is_balance_param_sent_ = true;
+
+    // call service
+    service_request_pool_.requestService("set balance param", SERVICE_TIMEOUT, set_balance_param_client_,
+                                         set_balance_param,
+                                         boost::bind(&QNodeThor3::applyBalanceParameter, this, set_balance_param));
+  }
 
-  marker_pub_.publish(marker_array);
+  setFeedBackGain();
 }
 
-void QNodeThor3::setBalanceParameter()
+void QNodeThor3::applyBalanceParameter(
+    boost::shared_ptr<thormang3_walking_module_msgs::SetBalanceParam> set_balance_param)
 {
-  bool service_result = false;
-
-  // call service
-  service_result = set_balance_param_client_.call(set_balance_param_srv_);
-  if (service_result == true)
+  int _result = set_balance_param->response.result;
+  if (_result == thormang3_walking_module_msgs::SetBalanceParam::Response::NO_ERROR)
   {
-    int _result = set_balance_param_srv_.response.result;
-    if (_result == thormang3_walking_module_msgs::SetBalanceParam::Response::NO_ERROR)
-    {
-      ROS_INFO("[Demo]  : Succeed to set balance param");
-      ROS_INFO("[Demo]  : Please wait 2 sec for turning on balance");
-      log(Info, "Set Walking Balance parameters");
-    }
-    else
-    {
-      if (_result & thormang3_walking_module_msgs::SetBalanceParam::Response::NOT_ENABLED_WALKING_MODULE)
-        ROS_ERROR("[Demo]  : BALANCE_PARAM_ERR::NOT_ENABLED_WALKING_MODULE");
-      if (_result & thormang3_walking_module_msgs::SetBalanceParam::Response::PREV_REQUEST_IS_NOT_FINISHED)
-        ROS_ERROR("[Demo]  : BALANCE_PARAM_ERR::PREV_REQUEST_IS_NOT_FINISHED");
-    }
+    ROS_INFO("[Demo]  : Succeed to set balance param");
+    ROS_INFO("[Demo]  : Please wait 2 sec for turning on balance");
+    log(Info, "Set Walking Balance parameters");
   }
   else
-    ROS_ERROR("[Demo]  : Failed to set balance param ");
+  {
+    // sent again at the next request
+    is_balance_param_sent_ = false;
 
-  setFeedBackGain();
+    if (_result & thormang3_walking_module_msgs::SetBalanceParam::Response::NOT_ENABLED_WALKING_MODULE)
+      ROS_ERROR("[Demo]  : BALANCE_PARAM_ERR::NOT_ENABLED_WALKING_MODULE");
+    if (_result & thormang3_walking_module_msgs::SetBalanceParam::Response::PREV_REQUEST_IS_NOT_FINISHED)
+      ROS_ERROR("[Demo]  : BALANCE_PARAM_ERR::PREV_REQUEST_IS_NOT_FINISHED");
+  }
 }
 
 bool QNodeThor3::loadBalanceParameterFromYaml()
 {
+  // parsed again only when the file is modified
+  time_t modified_time = getFileModifiedTime(balance_yaml_path_);
+  if (balance_param_preset_table_.empty() == false && modified_time == balance_yaml_modified_time_)
+    return true;
+
+  thormang3_walking_module_msgs::BalanceParam balance_param;
   YAML::Node doc;
   try
   {
@@ -1031,39 +1755,36 @@ bool QNodeThor3::loadBalanceParameterFromYaml()
     double foot_roll_torque_cut_off_frequency  = doc["foot_roll_torque_cut_off_frequency"].as<double>();
     double foot_pitch_torque_cut_off_frequency = doc["foot_pitch_torque_cut_off_frequency"].as<double>();
 
-    set_balance_param_srv_.request.updating_duration                                 = 2.0;
-    set_balance_param_srv_.request.balance_param.cob_x_offset_m                      =  cob_x_offset_m                     ;
-    set_balance_param_srv_.request.balance_param.cob_y_offset_m                      =  cob_y_offset_m                     ;
-    set_balance_param_srv_.request.balance_param.hip_roll_swap_angle_rad             =  hip_roll_swap_angle_rad            ;
-    set_balance_param_srv_.request.balance_param.foot_roll_gyro_p_gain               =  foot_roll_gyro_p_gain              ;
-    set_balance_param_srv_.request.balance_param.foot_roll_gyro_d_gain               =  foot_roll_gyro_d_gain              ;
-    set_balance_param_srv_.request.balance_param.foot_pitch_gyro_p_gain              =  foot_pitch_gyro_p_gain             ;
-    set_balance_param_srv_.request.balance_param.foot_pitch_gyro_d_gain              =  foot_pitch_gyro_d_gain             ;
-    set_balance_param_srv_.request.balance_param.foot_roll_angle_p_gain              =  foot_roll_angle_p_gain             ;
-    set_balance_param_srv_.request.balance_param.foot_roll_angle_d_gain              =  foot_roll_angle_d_gain             ;
-    set_balance_param_srv_.request.balance_param.foot_pitch_angle_p_gain             =  foot_pitch_angle_p_gain            ;
-    set_balance_param_srv_.request.balance_param.foot_pitch_angle_d_gain             =  foot_pitch_angle_d_gain            ;
-    set_balance_param_srv_.request.balance_param.foot_x_force_p_gain                 =  foot_x_force_p_gain                ;
-    set_balance_param_srv_.request.balance_param.foot_x_force_d_gain                 =  foot_x_force_d_gain                ;
-    set_balance_param_srv_.request.balance_param.foot_y_force_p_gain                 =  foot_y_force_p_gain                ;
-    set_balance_param_srv_.request.balance_param.foot_y_force_d_gain                 =  foot_y_force_d_gain                ;
-    set_balance_param_srv_.request.balance_param.foot_z_force_p_gain                 =  foot_z_force_p_gain                ;
-    set_balance_param_srv_.request.balance_param.foot_z_force_d_gain                 =  foot_z_force_d_gain                ;
-    set_balance_param_srv_.request.balance_param.foot_roll_torque_p_gain             =  foot_roll_torque_p_gain            ;
-    set_balance_param_srv_.request.balance_param.foot_roll_torque_d_gain             =  foot_roll_torque_d_gain            ;
-    set_balance_param_srv_.request.balance_param.foot_pitch_torque_p_gain            =  foot_pitch_torque_p_gain           ;
-    set_balance_param_srv_.request.balance_param.foot_pitch_torque_d_gain            =  foot_pitch_torque_d_gain           ;
-    set_balance_param_srv_.request.balance_param.roll_gyro_cut_off_frequency         =  roll_gyro_cut_off_frequency        ;
-    set_balance_param_srv_.request.balance_param.pitch_gyro_cut_off_frequency        =  pitch_gyro_cut_off_frequency       ;
-    set_balance_param_srv_.request.balance_param.roll_angle_cut_off_frequency        =  roll_angle_cut_off_frequency       ;
-    set_balance_param_srv_.request.balance_param.pitch_angle_cut_off_frequency       =  pitch_angle_cut_off_frequency      ;
-    set_balance_param_srv_.request.balance_param.foot_x_force_cut_off_frequency      =  foot_x_force_cut_off_frequency     ;
-    set_balance_param_srv_.request.balance_param.foot_y_force_cut_off_frequency      =  foot_y_force_cut_off_frequency     ;
-    set_balance_param_srv_.request.balance_param.foot_z_force_cut_off_frequency      =  foot_z_force_cut_off_frequency     ;
-    set_balance_param_srv_.request.balance_param.foot_roll_torque_cut_off_frequency  =  foot_roll_torque_cut_off_frequency ;
-    set_balance_param_srv_.request.balance_param.foot_pitch_torque_cut_off_frequency =  foot_pitch_torque_cut_off_frequency;
-
-    return true;
+    balance_param.cob_x_offset_m                      =  cob_x_offset_m                     ;
+    balance_param.cob_y_offset_m                      =  cob_y_offset_m                     ;
+    balance_param.hip_roll_swap_angle_rad             =  hip_roll_swap_angle_rad            ;
+    balance_param.foot_roll_gyro_p_gain               =  foot_roll_gyro_p_gain              ;
+    balance_param.foot_roll_gyro_d_gain               =  foot_roll_gyro_d_gain              ;
+    balance_param.foot_pitch_gyro_p_gain              =  foot_pitch_gyro_p_gain             ;
+    balance_param.foot_pitch_gyro_d_gain              =  foot_pitch_gyro_d_gain             ;
+    balance_param.foot_roll_angle_p_gain              =  foot_roll_angle_p_gain             ;
+    balance_param.foot_roll_angle_d_gain              =  foot_roll_angle_d_gain             ;
+    balance_param.foot_pitch_angle_p_gain             =  foot_pitch_angle_p_gain            ;
+    balance_param.foot_pitch_angle_d_gain             =  foot_pitch_angle_d_gain            ;
+    balance_param.foot_x_force_p_gain                 =  foot_x_force_p_gain                ;
+    balance_param.foot_x_force_d_gain                 =  foot_x_force_d_gain                ;
+    balance_param.foot_y_force_p_gain                 =  foot_y_force_p_gain                ;
+    balance_param.foot_y_force_d_gain                 =  foot_y_force_d_gain                ;
+    balance_param.foot_z_force_p_gain                 =  foot_z_force_p_gain                ;
+    balance_param.foot_z_force_d_gain                 =  foot_z_force_d_gain                ;
+    balance_param.foot_roll_torque_p_gain             =  foot_roll_torque_p_gain            ;
+    balance_param.foot_roll_torque_d_gain             =  foot_roll_torque_d_gain            ;
+    balance_param.foot_pitch_torque_p_gain            =  foot_pitch_torque_p_gain           ;
+    balance_param.foot_pitch_torque_d_gain            =  foot_pitch_torque_d_gain           ;
+    balance_param.roll_gyro_cut_off_frequency         =  roll_gyro_cut_off_frequency        ;
+    balance_param.pitch_gyro_cut_off_frequency        =  pitch_gyro_cut_off_frequency       ;
+    balance_param.roll_angle_cut_off_frequency        =  roll_angle_cut_off_frequency       ;
+    balance_param.pitch_angle_cut_off_frequency       =  pitch_angle_cut_off_frequency      ;
+    balance_param.foot_x_force_cut_off_frequency      =  foot_x_force_cut_off_frequency     ;
+    balance_param.foot_y_force_cut_off_frequency      =  foot_y_force_cut_off_frequency     ;
+    balance_param.foot_z_force_cut_off_frequency      =  foot_z_force_cut_off_frequency     ;
+    balance_param.foot_roll_torque_cut_off_frequency  =  foot_roll_torque_cut_off_frequency ;
+    balance_param.foot_pitch_torque_cut_off_frequency =  foot_pitch_torque_cut_off_frequency;
   }
   catch (const std::exception& e)
   {
@@ -1071,6 +1792,69 @@ bool QNodeThor3::loadBalanceParameterFromYaml()
     return false;
   }
 
+  balance_yaml_modified_time_ = modified_time;
+  makeBalanceParamPresets(balance_param);
+
+  return true;
+}
+
+void QNodeThor3::makeBalanceParamPresets(const thormang3_walking_module_msgs::BalanceParam &balance_param)
+{
+  balance_param_preset_table_.clear();
+  balance_param_preset_table_["normal"] = balance_param;
+
+  thormang3_walking_module_msgs::BalanceParam &off_param = balance_param_preset_table_["off"];
+  off_param = balance_param;
+  off_param.foot_roll_gyro_p_gain    = 0.0;
+  off_param.foot_roll_gyro_d_gain    = 0.0;
+  off_param.foot_pitch_gyro_p_gain   = 0.0;
+  off_param.foot_pitch_gyro_d_gain   = 0.0;
+  off_param.foot_roll_angle_p_gain   = 0.0;
+  off_param.foot_roll_angle_d_gain   = 0.0;
+  off_param.foot_pitch_angle_p_gain  = 0.0;
+  off_param.foot_pitch_angle_d_gain  = 0.0;
+  off_param.foot_x_force_p_gain      = 0.0;
+  off_param.foot_x_force_d_gain      = 0.0;
+  off_param.foot_y_force_p_gain      = 0.0;
+  off_param.foot_y_force_d_gain      = 0.0;
+  off_param.foot_z_force_p_gain      = 0.0;
+  off_param.foot_z_force_d_gain      = 0.0;
+  off_param.foot_roll_torque_p_gain  = 0.0;
+  off_param.foot_roll_torque_d_gain  = 0.0;
+  off_param.foot_pitch_torque_p_gain = 0.0;
+  off_param.foot_pitch_torque_d_gain = 0.0;
+
+  // the center of body is moved to the support foot during the kick
+  thormang3_walking_module_msgs::BalanceParam &kick_right_param = balance_param_preset_table_["kick_right"];
+  kick_right_param = balance_param;
+  kick_right_param.hip_roll_swap_angle_rad = 0;
+  kick_right_param.cob_x_offset_m -= 0.03;
+  kick_right_param.cob_y_offset_m += 0.02;
+
+  thormang3_walking_module_msgs::BalanceParam &kick_left_param = balance_param_preset_table_["kick_left"];
+  kick_left_param = balance_param;
+  kick_left_param.cob_x_offset_m -= 0.03;
+  kick_left_param.cob_y_offset_m -= 0.02;
+}
+
+bool QNodeThor3::setBalanceParameterPreset(const std::string &preset_name)
+{
+  // load param from yaml file
+  if (loadBalanceParameterFromYaml() == false)
+    return false;
+
+  std::map<std::string, thormang3_walking_module_msgs::BalanceParam>::iterator preset_it =
+      balance_param_preset_table_.find(preset_name);
+  if (preset_it == balance_param_preset_table_.end())
+  {
+    ROS_ERROR_STREAM("[Demo]  : unknown balance param preset : " << preset_name);
+    return false;
+  }
+
+  set_balance_param_srv_.request.updating_duration = BALANCE_UPDATING_DURATION;
+  set_balance_param_srv_.request.balance_param = preset_it->second;
+  setBalanceParameter();
+
   return true;
 }
 
@@ -1082,69 +1866,89 @@ bool QNodeThor3::setFeedBackGain()
   if (result_load == false)
     return false;
 
-  bool service_result = false;
+  // the walking module already has it
+  if (is_joint_feedback_gain_sent_ == true
+      && isSameMessage(sent_joint_feedback_gain_, set_joint_feedback_gain_srv_.request.feedback_gain))
+  {
+    ROS_INFO("[Demo]  : joint feedback gain is not changed");
+    return true;
+  }
+
+  boost::shared_ptr<thormang3_walking_module_msgs::SetJointFeedBackGain> set_feedback_gain(
+      new thormang3_walking_module_msgs::SetJointFeedBackGain);
+  set_feedback_gain->request = set_joint_feedback_gain_srv_.request;
+
+  sent_joint_feedback_gain_ = set_joint_feedback_gain_srv_.request.feedback_gain;
+  is_joint_feedback_gain_sent_ = true;
 
   // call service
-  service_result = set_joint_feedback_gain_client_.call(set_joint_feedback_gain_srv_);
-  if (service_result == true)
-  {
-    int _result = set_joint_feedback_gain_srv_.response.result;
+  service_request_pool_.requestService("set joint feedback gain", SERVICE_TIMEOUT, set_joint_feedback_gain_client_,
+                                       set_feedback_gain,
+                                       boost::bind(&QNodeThor3::applyFeedBackGain, this, set_feedback_gain));
+  return true;
+}
 
-    if (_result == thormang3_walking_module_msgs::SetJointFeedBackGain::Response::NO_ERROR)
-    {
-      ROS_INFO("[Demo]  : Succeed to set joint feedback gain");
-      log(Info, "Set Walking Joint FeedBack gain");
-    }
-    else
-    {
-      if (_result & thormang3_walking_module_msgs::SetJointFeedBackGain::Response::NOT_ENABLED_WALKING_MODULE)
-        ROS_ERROR("[Demo]  : FRRDBACK_GAIN_ERR::NOT_ENABLED_WALKING_MODULE");
-      if (_result & thormang3_walking_module_msgs::SetJointFeedBackGain::Response::PREV_REQUEST_IS_NOT_FINISHED)
-        ROS_ERROR("[Demo]  : FRRDBACK_GAIN_ERR::PREV_REQUEST_IS_NOT_FINISHED");
-    }
+void QNodeThor3::applyFeedBackGain(
+    boost::shared_ptr<thormang3_walking_module_msgs::SetJointFeedBackGain> set_feedback_gain)
+{
+  int _result = set_feedback_gain->response.result;
+
+  if (_result == thormang3_walking_module_msgs::SetJointFeedBackGain::Response::NO_ERROR)
+  {
+    ROS_INFO("[Demo]  : Succeed to set joint feedback gain");
+    log(Info, "Set Walking Joint FeedBack gain");
   }
   else
   {
-    ROS_ERROR("[Demo]  : Failed to set Joint Feedback Gain");
-    log(Error, "Fain to set Walking Joint FeedBack gain");
+    // sent again at the next request
+    is_joint_feedback_gain_sent_ = false;
+
+    if (_result & thormang3_walking_module_msgs::SetJointFeedBackGain::Response::NOT_ENABLED_WALKING_MODULE)
+      ROS_ERROR("[Demo]  : FRRDBACK_GAIN_ERR::NOT_ENABLED_WALKING_MODULE");
+    if (_result & thormang3_walking_module_msgs::SetJointFeedBackGain::Response::PREV_REQUEST_IS_NOT_FINISHED)
+      ROS_ERROR("[Demo]  : FRRDBACK_GAIN_ERR::PREV_REQUEST_IS_NOT_FINISHED");
   }
-    return true;
 }
 
 bool QNodeThor3::loadFeedbackGainFromYaml()
 {
+  // parsed again only when the file is modified
+  time_t modified_time = getFileModifiedTime(joint_feedback_yaml_path_);
+  if (joint_feedback_yaml_modified_time_ != 0 && modified_time == joint_feedback_yaml_modified_time_)
+    return true;
+
+  thormang3_walking_module_msgs::JointFeedBackGain feedback_gain;
   YAML::Node doc;
   try
   {
     // load yaml
     doc = YAML::LoadFile(joint_feedback_yaml_path_.c_str());
 
-    set_joint_feedback_gain_srv_.request.updating_duration                 = 2.0;
-    set_joint_feedback_gain_srv_.request.feedback_gain.r_leg_hip_y_p_gain  = doc["r_leg_hip_y_p_gain"].as<double>();
-    set_joint_feedback_gain_srv_.request.feedback_gain.r_leg_hip_y_d_gain  = doc["r_leg_hip_y_d_gain"].as<double>();
-    set_joint_feedback_gain_srv_.request.feedback_gain.r_leg_hip_r_p_gain  = doc["r_leg_hip_r_p_gain"].as<double>();
-    set_joint_feedback_gain_srv_.request.feedback_gain.r_leg_hip_r_d_gain  = doc["r_leg_hip_r_d_gain"].as<double>();
-    set_joint_feedback_gain_srv_.request.feedback_gain.r_leg_hip_p_p_gain  = doc["r_leg_hip_p_p_gain"].as<double>();
-    set_joint_feedback_gain_srv_.request.feedback_gain.r_leg_hip_p_d_gain  = doc["r_leg_hip_p_d_gain"].as<double>();
-    set_joint_feedback_gain_srv_.request.feedback_gain.r_leg_kn_p_p_gain   = doc["r_leg_kn_p_p_gain"].as<double>();
-    set_joint_feedback_gain_srv_.request.feedback_gain.r_leg_kn_p_d_gain   = doc["r_leg_kn_p_d_gain"].as<double>();
-    set_joint_feedback_gain_srv_.request.feedback_gain.r_leg_an_p_p_gain   = doc["r_leg_an_p_p_gain"].as<double>();
-    set_joint_feedback_gain_srv_.request.feedback_gain.r_leg_an_p_d_gain   = doc["r_leg_an_p_d_gain"].as<double>();
-    set_joint_feedback_gain_srv_.request.feedback_gain.r_leg_an_r_p_gain   = doc["r_leg_an_r_p_gain"].as<double>();
-    set_joint_feedback_gain_srv_.request.feedback_gain.r_leg_an_r_d_gain   = doc["r_leg_an_r_d_gain"].as<double>();
-
-    set_joint_feedback_gain_srv_.request.feedback_gain.l_leg_hip_y_p_gain  = doc["l_leg_hip_y_p_gain"].as<double>();
-    set_joint_feedback_gain_srv_.request.feedback_gain.l_leg_hip_y_d_gain  = doc["l_leg_hip_y_d_gain"].as<double>();
-    set_joint_feedback_gain_srv_.request.feedback_gain.l_leg_hip_r_p_gain  = doc["l_leg_hip_r_p_gain"].as<double>();
-    set_joint_feedback_gain_srv_.request.feedback_gain.l_leg_hip_r_d_gain  = doc["l_leg_hip_r_d_gain"].as<double>();
-    set_joint_feedback_gain_srv_.request.feedback_gain.l_leg_hip_p_p_gain  = doc["l_leg_hip_p_p_gain"].as<double>();
-    set_joint_feedback_gain_srv_.request.feedback_gain.l_leg_hip_p_d_gain  = doc["l_leg_hip_p_d_gain"].as<double>();
-    set_joint_feedback_gain_srv_.request.feedback_gain.l_leg_kn_p_p_gain   = doc["l_leg_kn_p_p_gain"].as<double>();
-    set_joint_feedback_gain_srv_.request.feedback_gain.l_leg_kn_p_d_gain   = doc["l_leg_kn_p_d_gain"].as<double>();
-    set_joint_feedback_gain_srv_.request.feedback_gain.l_leg_an_p_p_gain   = doc["l_leg_an_p_p_gain"].as<double>();
-    set_joint_feedback_gain_srv_.request.feedback_gain.l_leg_an_p_d_gain   = doc["l_leg_an_p_d_gain"].as<double>();
-    set_joint_feedback_gain_srv_.request.feedback_gain.l_leg_an_r_p_gain   = doc["l_leg_an_r_p_gain"].as<double>();
-    set_joint_feedback_gain_srv_.request.feedback_gain.l_leg_an_r_d_gain   = doc["l_leg_an_r_d_gain"].as<double>();
+    feedback_gain.r_leg_hip_y_p_gain  = doc["r_leg_hip_y_p_gain"].as<double>();
+    feedback_gain.r_leg_hip_y_d_gain  = doc["r_leg_hip_y_d_gain"].as<double>();
+    feedback_gain.r_leg_hip_r_p_gain  = doc["r_leg_hip_r_p_gain"].as<double>();
+    feedback_gain.r_leg_hip_r_d_gain  = doc["r_leg_hip_r_d_gain"].as<double>();
+    feedback_gain.r_leg_hip_p_p_gain  = doc["r_leg_hip_p_p_gain"].as<double>();
+    feedback_gain.r_leg_hip_p_d_gain  = doc["r_leg_hip_p_d_gain"].as<double>();
+    feedback_gain.r_leg_kn_p_p_gain   = doc["r_leg_kn_p_p_gain"].as<double>();
+    feedback_gain.r_leg_kn_p_d_gain   = doc["r_leg_kn_p_d_gain"].as<double>();
+    feedback_gain.r_leg_an_p_p_gain   = doc["r_leg_an_p_p_gain"].as<double>();
+    feedback_gain.r_leg_an_p_d_gain   = doc["r_leg_an_p_d_gain"].as<double>();
+    feedback_gain.r_leg_an_r_p_gain   = doc["r_leg_an_r_p_gain"].as<double>();
+    feedback_gain.r_leg_an_r_d_gain   = doc["r_leg_an_r_d_gain"].as<double>();
+
+    feedback_gain.l_leg_hip_y_p_gain  = doc["l_leg_hip_y_p_gain"].as<double>();
+    feedback_gain.l_leg_hip_y_d_gain  = doc["l_leg_hip_y_d_gain"].as<double>();
+    feedback_gain.l_leg_hip_r_p_gain  = doc["l_leg_hip_r_p_gain"].as<double>();
+    feedback_gain.l_leg_hip_r_d_gain  = doc["l_leg_hip_r_d_gain"].as<double>();
+    feedback_gain.l_leg_hip_p_p_gain  = doc["l_leg_hip_p_p_gain"].as<double>();
+    feedback_gain.l_leg_hip_p_d_gain  = doc["l_leg_hip_p_d_gain"].as<double>();
+    feedback_gain.l_leg_kn_p_p_gain   = doc["l_leg_kn_p_p_gain"].as<double>();
+    feedback_gain.l_leg_kn_p_d_gain   = doc["l_leg_kn_p_d_gain"].as<double>();
+    feedback_gain.l_leg_an_p_p_gain   = doc["l_leg_an_p_p_gain"].as<double>();
+    feedback_gain.l_leg_an_p_d_gain   = doc["l_leg_an_p_d_gain"].as<double>();
+    feedback_gain.l_leg_an_r_p_gain   = doc["l_leg_an_r_p_gain"].as<double>();
+    feedback_gain.l_leg_an_r_d_gain   = doc["l_leg_an_r_d_gain"].as<double>();
   }
   catch (const std::exception& e)
   {
@@ -1152,52 +1956,26 @@ bool QNodeThor3::loadFeedbackGainFromYaml()
     return false;
   }
 
+  joint_feedback_yaml_modified_time_ = modified_time;
+  set_joint_feedback_gain_srv_.request.updating_duration = BALANCE_UPDATING_DURATION;
+  set_joint_feedback_gain_srv_.request.feedback_gain = feedback_gain;
+
   return true;
 }
 
 void QNodeThor3::turnOnBalance()
 {
-  // load param from yaml file
-  bool result_load = loadBalanceParameterFromYaml();
-
-  if (result_load == false)
+  if (setBalanceParameterPreset("normal") == false)
     return;
 
-  setBalanceParameter();
-
   log(Info, "Turn On Walking Balance");
 }
 
 void QNodeThor3::turnOffBalance()
 {
-  // load param from yaml file
-  bool result_load = loadBalanceParameterFromYaml();
-
-  if (result_load == false)
+  if (setBalanceParameterPreset("off") == false)
     return;
 
-  set_balance_param_srv_.request.updating_duration = 2.0;
-  set_balance_param_srv_.request.balance_param.foot_roll_gyro_p_gain               =  0.0;
-  set_balance_param_srv_.request.balance_param.foot_roll_gyro_d_gain               =  0.0;
-  set_balance_param_srv_.request.balance_param.foot_pitch_gyro_p_gain              =  0.0;
-  set_balance_param_srv_.request.balance_param.foot_pitch_gyro_d_gain              =  0.0;
-  set_balance_param_srv_.request.balance_param.foot_roll_angle_p_gain              =  0.0;
-  set_balance_param_srv_.request.balance_param.foot_roll_angle_d_gain              =  0.0;
-  set_balance_param_srv_.request.balance_param.foot_pitch_angle_p_gain             =  0.0;
-  set_balance_param_srv_.request.balance_param.foot_pitch_angle_d_gain             =  0.0;
-  set_balance_param_srv_.request.balance_param.foot_x_force_p_gain                 =  0.0;
-  set_balance_param_srv_.request.balance_param.foot_x_force_d_gain                 =  0.0;
-  set_balance_param_srv_.request.balance_param.foot_y_force_p_gain                 =  0.0;
-  set_balance_param_srv_.request.balance_param.foot_y_force_d_gain                 =  0.0;
-  set_balance_param_srv_.request.balance_param.foot_z_force_p_gain                 =  0.0;
-  set_balance_param_srv_.request.balance_param.foot_z_force_d_gain                 =  0.0;
-  set_balance_param_srv_.request.balance_param.foot_roll_torque_p_gain             =  0.0;
-  set_balance_param_srv_.request.balance_param.foot_roll_torque_d_gain             =  0.0;
-  set_balance_param_srv_.request.balance_param.foot_pitch_torque_p_gain            =  0.0;
-  set_balance_param_srv_.request.balance_param.foot_pitch_torque_d_gain            =  0.0;
-
-  setBalanceParameter();
-
   log(Info, "Turn Off Walking Balance");
 }
 
@@ -1231,9 +2009,9 @@ void QNodeThor3::playMotion(int motion_index, bool to_action_script)
   motion_msg.data = motion_index;
 
   if (to_action_script == true)
-    motion_index_pub_.publish(motion_msg);
+    publishCommand(motion_index_pub_, motion_msg);
   else
-    motion_page_pub_.publish(motion_msg);
+    publishCommand(motion_page_pub_, motion_msg);
 
   log(Info, log_stream.str());
 }
@@ -1252,8 +2030,10 @@ void QNodeThor3::poseCallback(const geometry_msgs::Pose::ConstPtr &msg)
     case MANIPULATION_UI:
     {
       double z_offset = 0.723;
-      Q_EMIT updateCurrPos(msg->position.x, msg->position.y, msg->position.z + z_offset);
-      Q_EMIT updateCurrOri(msg->orientation.x, msg->orientation.y, msg->orientation.z, msg->orientation.w);
+      geometry_msgs::Pose &curr_pose = curr_pose_channel_.getWriteValue();
+      curr_pose = *msg;
+      curr_pose.position.z += z_offset;
+      curr_pose_channel_.publish();
       log(Info, "Get Pose For IK");
       break;
     }
@@ -1271,7 +2051,14 @@ void QNodeThor3::pointStampedCallback(const geometry_msgs::PointStamped::ConstPt
   frame_id_ = msg->header.frame_id;
 
   // update point ui
-  Q_EMIT updateDemoPoint(msg->point);
+  if (demo_point_channel_.push(msg->point) == false)
+    ROS_WARN("Clicked points are not taken by the gui");
+}
+
+void QNodeThor3::mapCallback(const topic_tools::ShapeShifter::ConstPtr &msg)
+{
+  // the cached footstep plans are made on the previous map
+  map_version_.fetch_add(1, boost::memory_order_relaxed);
 }
 
 void QNodeThor3::interactiveMarkerFeedback(const visualization_msgs::InteractiveMarkerFeedbackConstPtr &feedback)
@@ -1287,10 +2074,9 @@ void QNodeThor3::interactiveMarkerFeedback(const visualization_msgs::Interactive
 
     case visualization_msgs::InteractiveMarkerFeedback::POSE_UPDATE:
     {
-      current_pose_ = feedback->pose;
-
-      // update pose ui
-      Q_EMIT updateDemoPose(feedback->pose);
+      // the server has the pose already, the pose ui and the other clients are updated once a frame
+      marker_pose_channel_.push(feedback->pose);
+      is_marker_dragged_.store(true, boost::memory_order_release);
 
       break;
     }
@@ -1303,8 +2089,6 @@ void QNodeThor3::interactiveMarkerFeedback(const visualization_msgs::Interactive
     default:
       break;
   }
-
-  interactive_marker_server_->applyChanges();
 }
 
 void QNodeThor3::makeInteractiveMarker(const geometry_msgs::Pose &marker_pose)
@@ -1448,30 +2232,59 @@ void QNodeThor3::makeInteractiveMarker(const geometry_msgs::Pose &marker_pose)
                                           boost::bind(&QNodeThor3::interactiveMarkerFeedback, this, _1));
 
   interactive_marker_server_->applyChanges();
+
+  is_marker_shown_ = true;
+  is_marker_pose_pending_ = false;
+  is_applied_marker_pose_valid_ = true;
+  applied_marker_pose_ = marker_pose;
 }
 
+// the pose is applied at the next frame, the poses set before it are dropped
 void QNodeThor3::updateInteractiveMarker(const geometry_msgs::Pose &pose)
 {
-  ROS_INFO("Update Interactive Marker Pose");
-
-  visualization_msgs::InteractiveMarker interactive_marker;
-  bool result_getting = false;
-
-  result_getting = interactive_marker_server_->get(marker_name_, interactive_marker);
-  if (result_getting == false)
+  if (is_marker_shown_ == false)
   {
     ROS_ERROR("No Interactive marker to set pose");
     return;
   }
 
-  interactive_marker_server_->setPose(interactive_marker.name, pose);
-  interactive_marker_server_->applyChanges();
+  pending_marker_pose_ = pose;
+  is_marker_pose_pending_ = true;
+}
+
+// called once a frame from the gui, changes of both sides are sent with one applyChanges()
+void QNodeThor3::flushInteractiveMarker()
+{
+  bool is_changed = is_marker_dragged_.exchange(false, boost::memory_order_acq_rel);
+  if (is_changed == true)
+    is_applied_marker_pose_valid_ = false;
+
+  if (is_marker_pose_pending_ == true)
+  {
+    is_marker_pose_pending_ = false;
+
+    if (is_applied_marker_pose_valid_ == false || isSameMessage(applied_marker_pose_, pending_marker_pose_) == false)
+    {
+      ROS_INFO("Update Interactive Marker Pose");
+
+      interactive_marker_server_->setPose(marker_name_, pending_marker_pose_);
+      applied_marker_pose_ = pending_marker_pose_;
+      is_applied_marker_pose_valid_ = true;
+      is_changed = true;
+    }
+  }
+
+  if (is_changed == true)
+    interactive_marker_server_->applyChanges();
 }
 
 void QNodeThor3::getInteractiveMarkerPose()
 {
   ROS_INFO("Get Interactive Marker Pose");
 
+  // the pose set from the gui at this frame
+  flushInteractiveMarker();
+
   visualization_msgs::InteractiveMarker _interactive_marker;
   if (!(interactive_marker_server_->get(marker_name_, _interactive_marker)))
   {
@@ -1492,78 +2305,92 @@ void QNodeThor3::clearInteractiveMarker()
   // clear and apply
   interactive_marker_server_->clear();
   interactive_marker_server_->applyChanges();
+
+  is_marker_shown_ = false;
+  is_marker_pose_pending_ = false;
+  is_marker_dragged_.store(false, boost::memory_order_release);
 }
 
 void QNodeThor3::kickDemo(const std::string &kick_foot)
 {
-  if (kick_foot == "right kick")
-  {
-    bool result = loadBalanceParameterFromYaml();
-    if (result == false)
-      return;
+  if (kick_foot != "right kick" && kick_foot != "left kick")
+    return;
 
-    double old_hip_swap = set_balance_param_srv_.request.balance_param.hip_roll_swap_angle_rad;
-    set_balance_param_srv_.request.balance_param.hip_roll_swap_angle_rad = 0;
-    set_balance_param_srv_.request.balance_param.cob_x_offset_m -= 0.03;
-    set_balance_param_srv_.request.balance_param.cob_y_offset_m += 0.02;
-    setBalanceParameter();
+  if (kick_demo_state_ != KickDemoIdle)
+  {
+    log(Warn, "Kick demo is running.");
+    return;
+  }
 
-    thormang3_foot_step_generator::FootStepCommand msg;
-    msg.command = kick_foot;
-    setWalkingCommand(msg);
+  // restored to "normal" after the kick
+  if (setBalanceParameterPreset(kick_foot == "right kick" ? "kick_right" : "kick_left") == false)
+    return;
 
-    // wait for kick
-    usleep(7.2 * 1000 * 1000);
+  thormang3_foot_step_generator::FootStepCommand msg;
+  msg.command = kick_foot;
+  setWalkingCommand(msg);
 
-    set_balance_param_srv_.request.balance_param.hip_roll_swap_angle_rad = old_hip_swap;
-    set_balance_param_srv_.request.balance_param.cob_x_offset_m += 0.03;
-    set_balance_param_srv_.request.balance_param.cob_y_offset_m -= 0.02;
-    setBalanceParameter();
+  // wait for kick, walkingFinished() is called at the end of it
+  kick_demo_state_ = KickDemoKicking;
+  kick_demo_timer_.start(KICK_TIMEOUT_MS);
+}
 
-    // wait for recovering balance
-    usleep(2 * 1000 * 1000);
-  }
-  else if (kick_foot == "left kick")
+void QNodeThor3::walkingFinished()
+{
+  // the robot stopped at the ending step of the first steps before the rest was planned
+  if (is_rest_footsteps_pending_ == true && is_walking_finished_before_rest_ == false)
   {
-    bool result = loadBalanceParameterFromYaml();
-    if (result == false)
-      return;
-
-    double old_hip_swap = set_balance_param_srv_.request.balance_param.hip_roll_swap_angle_rad;
-    set_balance_param_srv_.request.balance_param.cob_x_offset_m -= 0.03;
-    set_balance_param_srv_.request.balance_param.cob_y_offset_m -= 0.02;
-    setBalanceParameter();
+    is_walking_finished_before_rest_ = true;
+    log(Warn, "The robot stopped before the rest of the footsteps, they are walked when they are planned.");
+  }
 
-    thormang3_foot_step_generator::FootStepCommand msg;
-    msg.command = kick_foot;
-    setWalkingCommand(msg);
+  if (kick_demo_state_ != KickDemoKicking)
+    return;
 
-    // wait for kick
-    usleep(7.2 * 1000 * 1000);
+  setBalanceParameterPreset("normal");
 
-    set_balance_param_srv_.request.balance_param.hip_roll_swap_angle_rad = old_hip_swap;
-    set_balance_param_srv_.request.balance_param.cob_x_offset_m += 0.03;
-    set_balance_param_srv_.request.balance_param.cob_y_offset_m += 0.02;
-    setBalanceParameter();
+  // wait for recovering balance
+  kick_demo_state_ = KickDemoRecovering;
+  kick_demo_timer_.start(BALANCE_UPDATING_DURATION * 1000);
+}
 
-    // wait for recovering balance
-    usleep(2 * 1000 * 1000);
+void QNodeThor3::kickDemoTimeout()
+{
+  if (kick_demo_state_ == KickDemoKicking)
+  {
+    log(Warn, "Walking module did not report the end of the kick.");
+    walkingFinished();
+  }
+  else if (kick_demo_state_ == KickDemoRecovering)
+  {
+    kick_demo_state_ = KickDemoIdle;
+    log(Info, "Kick demo is finished.");
   }
 }
 
 // Overload
 void QNodeThor3::overloadStatusCallback(const thormang3_alarm_module_msgs::JointOverloadStatus::ConstPtr &msg)
 {
-  for(int ix = 0; ix < msg->name.size(); ix++)
+  joint_index_cache_.updateLayout(overload_status_layout_, msg->name);
+
+  int right_index = joint_index_cache_.getMsgIndex(overload_status_layout_, right_knee_joint_index_);
+  if (right_index != -1)
   {
-    if(msg->name[ix].find("r_leg_kn_p") != std::string::npos)
-    {
-      Q_EMIT updateOverloadStatus(Right, msg->status[ix], msg->warning_count[ix], msg->error_count[ix]);
-    }
-    else if(msg->name[ix].find("l_leg_kn_p") != std::string::npos)
-    {
-      Q_EMIT updateOverloadStatus(Left, msg->status[ix], msg->warning_count[ix], msg->error_count[ix]);
-    }
+    OverloadState &state = overload_state_channel_[Right].getWriteValue();
+    state.status = msg->status[right_index];
+    state.warning_count = msg->warning_count[right_index];
+    state.error_count = msg->error_count[right_index];
+    overload_state_channel_[Right].publish();
+  }
+
+  int left_index = joint_index_cache_.getMsgIndex(overload_status_layout_, left_knee_joint_index_);
+  if (left_index != -1)
+  {
+    OverloadState &state = overload_state_channel_[Left].getWriteValue();
+    state.status = msg->status[left_index];
+    state.warning_count = msg->warning_count[left_index];
+    state.error_count = msg->error_count[left_index];
+    overload_state_channel_[Left].publish();
   }
 }
 
@@ -1572,84 +2399,306 @@ void QNodeThor3::publishAlarmCommand(const std::string &command)
   std_msgs::String comm_msg;
   comm_msg.data = command;
 
-  overload_com_pub_.publish(comm_msg);
+  publishCommand(overload_com_pub_, comm_msg);
   log(Info, "send overload command" + command);
 }
 
+// Command log
+bool QNodeThor3::startRecordingCommands(const std::string &path)
+{
+  if (command_log_writer_.open(path) == false)
+  {
+    log(Error, "Failed to open the command log : " + path);
+    return false;
+  }
+
+  log(Info, "Recording commands : " + path);
+  return true;
+}
+
+void QNodeThor3::stopRecordingCommands()
+{
+  if (command_log_writer_.isOpen() == false)
+    return;
+
+  command_log_writer_.close();
+  log(Info, "Stopped recording commands");
+}
+
+void QNodeThor3::abortRecordingCommands()
+{
+  command_log_writer_.close();
+  log(Error, "Failed to write the command log, recording is stopped");
+
+  Q_EMIT commandRecordingAborted();
+}
+
+bool QNodeThor3::replayCommands(const std::string &path, bool real_time)
+{
+  stopReplayingCommands();
+
+  if (command_log_reader_.open(path) == false)
+  {
+    log(Error, "Failed to open the command log : " + path);
+    return false;
+  }
+
+  if (command_log_reader_.readNext(next_command_record_) == false)
+  {
+    command_log_reader_.close();
+    log(Warn, "No command in the log : " + path);
+    return false;
+  }
+
+  is_replaying_commands_ = true;
+  is_real_time_replay_ = real_time;
+  replayed_command_count_ = 0;
+
+  // the first command is sent at once
+  command_replay_start_time_ = ros::WallTime::now() - ros::WallDuration(next_command_record_.time);
+
+  log(Info, std::string("Replaying commands") + (real_time == true ? " : " : " as fast as possible : ") + path);
+  scheduleNextCommand();
+
+  return true;
+}
+
+void QNodeThor3::stopReplayingCommands()
+{
+  if (is_replaying_commands_ == false)
+    return;
+
+  command_replay_timer_.stop();
+  log(Info, "Stopped replaying commands");
+  finishReplayingCommands();
+}
+
+void QNodeThor3::scheduleNextCommand()
+{
+  int delay_ms = 0;
+
+  if (is_real_time_replay_ == true)
+  {
+    ros::WallTime send_time = command_replay_start_time_ + ros::WallDuration(next_command_record_.time);
+    delay_ms = std::max(0, static_cast<int>((send_time - ros::WallTime::now()).toSec() * 1000));
+  }
+
+  // the gui keeps running between the commands
+  command_replay_timer_.start(delay_ms);
+}
+
+void QNodeThor3::replayNextCommand()
+{
+  if (is_replaying_commands_ == false)
+    return;
+
+  std::map<std::string, ReplayFunction>::iterator replay_it = replay_function_table_.find(next_command_record_.topic);
+  if (replay_it == replay_function_table_.end())
+    log(Warn, "Skipped a command of unknown topic : " + next_command_record_.topic);
+  else if (replay_it->second(next_command_record_) == false)
+    log(Warn, "Skipped a command of different type or broken data : " + next_command_record_.topic);
+  else
+    replayed_command_count_ += 1;
+
+  if (command_log_reader_.readNext(next_command_record_) == false)
+  {
+    std::stringstream ss;
+    ss << "Replayed " << replayed_command_count_ << " commands";
+    log(Info, ss.str());
+
+    finishReplayingCommands();
+    return;
+  }
+
+  scheduleNextCommand();
+}
+
+void QNodeThor3::finishReplayingCommands()
+{
+  command_log_reader_.close();
+  is_replaying_commands_ = false;
+
+  Q_EMIT commandReplayFinished();
+}
+
 // LOG
 void QNodeThor3::statusMsgCallback(const robotis_controller_msgs::StatusMsg::ConstPtr &msg)
 {
   log((LogLevel) msg->type, msg->status_msg, msg->module_name);
+
+  // walking module reports the end of the walking(or the kick)
+  if (msg->module_name == "Walking" && msg->status_msg == "Walking_Finished")
+    Q_EMIT walkingStatusFinished();
+
+  // the end of the latency of a walking command
+  if (msg->module_name == "Walking" && msg->status_msg == "Walking_Started")
+    walking_started_channel_.push(msg->header.stamp.isZero() ? ros::Time::now() : msg->header.stamp);
 }
 
-void QNodeThor3::log(const LogLevel &level, const std::string &msg, std::string sender)
+void QNodeThor3::commandLatencyCallback(const thormang3_foot_step_generator::CommandLatency::ConstPtr &msg)
 {
-  logging_model_.insertRows(logging_model_.rowCount(), 1);
-  std::stringstream logging_model_msg;
+  command_latency_channel_.push(*msg);
+}
 
-  ros::Duration duration_time = ros::Time::now() - start_time_;
-  int current_time = duration_time.sec;
-  int min_time = 0, sec_time = 0;
-  min_time = (int) (current_time / 60);
-  sec_time = (int) (current_time % 60);
+bool QNodeThor3::takeWalkingCommandLatency(WalkingCommandLatency &latency)
+{
+  bool is_updated = false;
+
+  // the start can be reported before the latency
+  ros::Time started_time;
+  if (walking_started_channel_.takeLatest(started_time) == true)
+    walking_started_time_ = started_time;
+
+  const thormang3_foot_step_generator::CommandLatency *reported = command_latency_channel_.takeLatest();
+  if (reported != NULL)
+  {
+    double nan = std::numeric_limits<double>::quiet_NaN();
+    bool is_published_known = reported->published.isZero() == false;
+
+    walking_command_latency_.command_id = reported->command_id;
+    walking_command_latency_.command = reported->command;
+    walking_command_latency_.result = reported->result;
+    walking_command_latency_.sent =
+        is_published_known == true ? (reported->received - reported->published).toSec() * 1000.0 : nan;
+    walking_command_latency_.ref_step = (reported->ref_step_fetched - reported->received).toSec() * 1000.0;
+    walking_command_latency_.generation = (reported->steps_generated - reported->ref_step_fetched).toSec() * 1000.0;
+    walking_command_latency_.acceptance = (reported->module_accepted - reported->steps_generated).toSec() * 1000.0;
+    walking_command_latency_.total =
+        is_published_known == true ? (reported->module_accepted - reported->published).toSec() * 1000.0 : nan;
+    walking_command_latency_.walking_start = nan;
+
+    walking_command_published_ = reported->published;
+    // a command to the walking robot makes no start, it is waited only until the next command is published.
+    // the report of a command followed by another one is late, the start is of the later one
+    bool is_last_command = reported->command_id == last_walking_command_id_ || is_replaying_commands_ == true;
+    is_walking_start_pending_ = is_published_known == true && is_last_command == true
+        && isWalkingStartCommand(reported->command) == true
+        && reported->result == thormang3_walking_module_msgs::AddStepDataArray::Response::NO_ERROR;
+
+    std::stringstream ss;
+    ss << "Walking Command Latency #" << reported->command_id << " " << reported->command << " [ms] : sent "
+       << walking_command_latency_.sent << ", ref step " << walking_command_latency_.ref_step << ", steps "
+       << walking_command_latency_.generation << ", accepted " << walking_command_latency_.acceptance << ", total "
+       << walking_command_latency_.total;
+    log(reported->result == thormang3_walking_module_msgs::AddStepDataArray::Response::NO_ERROR ? Info : Warn,
+        ss.str());
+
+    is_updated = true;
+  }
+
+  if (is_walking_start_pending_ == true && walking_started_time_ >= walking_command_published_)
+  {
+    walking_command_latency_.walking_start = (walking_started_time_ - walking_command_published_).toSec() * 1000.0;
+    is_walking_start_pending_ = false;
+
+    std::stringstream ss;
+    ss << "Walking Command #" << walking_command_latency_.command_id << " started in "
+       << walking_command_latency_.walking_start << " ms";
+    log(Info, ss.str());
+
+    is_updated = true;
+  }
+
+  if (is_updated == true)
+    latency = walking_command_latency_;
+
+  return is_updated;
+}
 
-  std::stringstream min_str, sec_str;
-  if (min_time < 10)
-    min_str << "0";
-  if (sec_time < 10)
-    sec_str << "0";
-  min_str << min_time;
-  sec_str << sec_time;
+void QNodeThor3::serviceRequestFinished(int request_id, QString name, int result)
+{
+  std::string request_name = name.toStdString();
+
+  // the walking module may not have the last sent one, it is sent again at the next request
+  if (result != ServiceRequestPool::Succeeded)
+  {
+    if (request_name == "set balance param")
+      is_balance_param_sent_ = false;
+    else if (request_name == "set joint feedback gain")
+      is_joint_feedback_gain_sent_ = false;
+    else if (request_name == "plan rest footsteps" && result != ServiceRequestPool::Canceled
+        && is_rest_footsteps_pending_ == true)
+      appendRestFootsteps(rest_foot_steps_, rest_foot_types_);  // the rest of the walked plan
+    else if (request_name == "plan footsteps" && result != ServiceRequestPool::Canceled
+        && preview_foot_steps_.size() == 0)
+      visualizePreviewFootsteps(true);  // clear the preview of the previous plan, the first solution is kept
+  }
+
+  switch (result)
+  {
+    case ServiceRequestPool::Failed:
+      ROS_ERROR_STREAM("[Demo]  : Failed to " << request_name);
+      log(Error, "fail to " + request_name + ".");
+      break;
+
+    case ServiceRequestPool::TimedOut:
+      ROS_ERROR_STREAM("[Demo]  : Timed out to " << request_name);
+      log(Error, "timed out to " + request_name + ".");
+      break;
 
-  std::stringstream stream_sender;
-  stream_sender << "[" << sender << "] ";
+    case ServiceRequestPool::Canceled:
+      log(Warn, "canceled to " + request_name + ".");
+      break;
+
+    default:
+      break;
+  }
+}
+
+void QNodeThor3::log(const LogLevel &level, const std::string &msg, std::string sender)
+{
+  ros::Duration duration_time = ros::Time::now() - start_time_;
+  int current_time = duration_time.sec;
+  const char *level_str = "";
 
   switch (level)
   {
     case (Debug):
     {
       ROS_DEBUG_STREAM(msg);
-      logging_model_msg << "[DEBUG] [" << min_str.str() << ":" << sec_str.str() << "]: " << stream_sender.str() << msg;
+      level_str = "[DEBUG]";
       break;
     }
     case (Info):
     {
       ROS_INFO_STREAM(msg);
-      logging_model_msg << "[INFO] [" << min_str.str() << ":" << sec_str.str() << "]: " << stream_sender.str() << msg;
+      level_str = "[INFO]";
       break;
     }
     case (Warn):
     {
       ROS_WARN_STREAM(msg);
-      logging_model_msg << "[WARN] [" << min_str.str() << ":" << sec_str.str() << "]: " << stream_sender.str() << msg;
+      level_str = "[WARN]";
       break;
     }
     case (Error):
     {
       ROS_ERROR_STREAM(msg);
-      logging_model_msg << "<ERROR> [" << min_str.str() << ":" << sec_str.str() << "]: " << stream_sender.str() << msg;
+      level_str = "<ERROR>";
       break;
     }
     case (Fatal):
     {
       ROS_FATAL_STREAM(msg);
-      logging_model_msg << "[FATAL] [" << min_str.str() << ":" << sec_str.str() << "]: " << stream_sender.str() << msg;
+      level_str = "[FATAL]";
       break;
     }
   }
 
-  QVariant new_row(QString(logging_model_msg.str().c_str()));
-  logging_model_.setData(logging_model_.index(logging_model_.rowCount() - 1), new_row);
+  // "[INFO] [mm:ss]: [sender] msg", the view is updated by the model in a batch
+  char log_header[32];
+  snprintf(log_header, sizeof(log_header), "%s [%02d:%02d]: ", level_str, current_time / 60, current_time % 60);
+
+  QString logging_model_msg(log_header);
+  logging_model_msg += QString("[%1] ").arg(sender.c_str());
+  logging_model_msg += msg.c_str();
 
-  Q_EMIT loggingUpdated();  // used to readjust the scrollbar
+  logging_model_.appendLog(logging_model_msg);
 }
 
 void QNodeThor3::clearLog()
 {
-  if (logging_model_.rowCount() == 0)
-    return;
-
-  logging_model_.removeRows(0, logging_model_.rowCount());
+  logging_model_.clear();
 }
 
 }  // namespace thormang3_demo
@@ -0,0 +1,263 @@
+/*******************************************************************************
+* Copyright 2018 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+/*****************************************************************************
+ ** Includes
+ *****************************************************************************/
+
+#include "../include/thormang3_demo/service_request_pool.hpp"
+
+/*****************************************************************************
+ ** Namespaces
+ *****************************************************************************/
+
+namespace thormang3_demo
+{
+
+/*****************************************************************************
+ ** Implementation
+ *****************************************************************************/
+
+ServiceRequestPool::ServiceRequestPool(int thread_num, QObject *parent)
+    : QObject(parent),
+      last_request_id_(0),
+      stop_(false)
+{
+  for (int ix = 0; ix < thread_num; ix++)
+    worker_threads_.create_thread(boost::bind(&ServiceRequestPool::processRequests, this));
+
+  QObject::connect(&timeout_timer_, SIGNAL(timeout()), this, SLOT(checkTimeout()));
+  timeout_timer_.start(TIMEOUT_CHECK_INTERVAL_MS);
+}
+
+ServiceRequestPool::~ServiceRequestPool()
+{
+  timeout_timer_.stop();
+
+  {
+    boost::mutex::scoped_lock lock(request_mutex_);
+    stop_ = true;
+  }
+  request_cond_.notify_all();
+
+  // a worker in a service call returns when ros is shut down
+  worker_threads_.join_all();
+}
+
+int ServiceRequestPool::request(const std::string &name, double timeout_sec, const CallFunction &call,
+                                const ApplyFunction &apply)
+{
+  int request_id;
+  {
+    boost::mutex::scoped_lock lock(request_mutex_);
+
+    request_id = ++last_request_id_;
+
+    Request &request = request_table_[request_id];
+    request.name = name;
+    request.deadline = ros::WallTime::now() + ros::WallDuration(timeout_sec);
+    request.call = call;
+    request.apply = apply;
+    request.called = false;
+    request.call_result = false;
+
+    waiting_request_list_.push_back(request_id);
+  }
+  request_cond_.notify_one();
+
+  return request_id;
+}
+
+void ServiceRequestPool::cancel(int request_id)
+{
+  removeRequest(request_id, Canceled);
+}
+
+void ServiceRequestPool::cancel(const std::string &name)
+{
+  std::vector<int> request_id_list;
+  {
+    boost::mutex::scoped_lock lock(request_mutex_);
+
+    for (std::map<int, Request>::iterator request_it = request_table_.begin(); request_it != request_table_.end();
+        ++request_it)
+    {
+      if (request_it->second.name == name)
+        request_id_list.push_back(request_it->first);
+    }
+  }
+
+  for (int ix = 0; ix < request_id_list.size(); ix++)
+    removeRequest(request_id_list[ix], Canceled);
+}
+
+bool ServiceRequestPool::isRequested(const std::string &name)
+{
+  boost::mutex::scoped_lock lock(request_mutex_);
+
+  for (std::map<int, Request>::iterator request_it = request_table_.begin(); request_it != request_table_.end();
+      ++request_it)
+  {
+    if (request_it->second.name == name)
+      return true;
+  }
+
+  return false;
+}
+
+void ServiceRequestPool::finishRequest(int request_id)
+{
+  Request request;
+  {
+    boost::mutex::scoped_lock lock(request_mutex_);
+
+    std::map<int, Request>::iterator request_it = request_table_.find(request_id);
+
+    // already canceled or timed out
+    if (request_it == request_table_.end() || request_it->second.called == false)
+      return;
+
+    request = request_it->second;
+    request_table_.erase(request_it);
+  }
+
+  if (request.call_result == true && request.apply)
+    request.apply();
+
+  Q_EMIT requestFinished(request_id, QString::fromStdString(request.name),
+                         request.call_result == true ? Succeeded : Failed);
+}
+
+void ServiceRequestPool::checkTimeout()
+{
+  std::vector<int> request_id_list;
+  {
+    boost::mutex::scoped_lock lock(request_mutex_);
+
+    if (request_table_.empty())
+      return;
+
+    ros::WallTime now = ros::WallTime::now();
+    for (std::map<int, Request>::iterator request_it = request_table_.begin(); request_it != request_table_.end();
+        ++request_it)
+    {
+      // the result of a finished call is already queued to the gui thread
+      if (request_it->second.called == false && request_it->second.deadline < now)
+        request_id_list.push_back(request_it->first);
+    }
+  }
+
+  for (int ix = 0; ix < request_id_list.size(); ix++)
+    removeRequest(request_id_list[ix], TimedOut);
+}
+
+void ServiceRequestPool::removeRequest(int request_id, RequestResult result)
+{
+  std::string name;
+  {
+    boost::mutex::scoped_lock lock(request_mutex_);
+
+    std::map<int, Request>::iterator request_it = request_table_.find(request_id);
+    if (request_it == request_table_.end())
+      return;
+
+    // the worker of a running request finds it removed after the call
+    name = request_it->second.name;
+    request_table_.erase(request_it);
+  }
+
+  Q_EMIT requestFinished(request_id, QString::fromStdString(name), result);
+}
+
+void ServiceRequestPool::processRequests()
+{
+  int request_id;
+  std::string name;
+  CallFunction call;
+
+  while (takeRequest(request_id, name, call) == true)
+  {
+    bool call_result = false;
+    try
+    {
+      call_result = call();
+    }
+    catch (const std::exception &e)
+    {
+      ROS_ERROR_STREAM("[Demo]  : service request exception : " << e.what());
+      call_result = false;
+    }
+    call.clear();
+
+    {
+      boost::mutex::scoped_lock lock(request_mutex_);
+
+      running_name_set_.erase(name);
+
+      std::map<int, Request>::iterator request_it = request_table_.find(request_id);
+      if (request_it != request_table_.end())
+      {
+        request_it->second.called = true;
+        request_it->second.call_result = call_result;
+      }
+    }
+    // the next request of the same name can be taken
+    request_cond_.notify_all();
+
+    QMetaObject::invokeMethod(this, "finishRequest", Qt::QueuedConnection, Q_ARG(int, request_id));
+  }
+}
+
+bool ServiceRequestPool::takeRequest(int &request_id, std::string &name, CallFunction &call)
+{
+  boost::mutex::scoped_lock lock(request_mutex_);
+
+  while (stop_ == false)
+  {
+    std::deque<int>::iterator waiting_it = waiting_request_list_.begin();
+    while (waiting_it != waiting_request_list_.end())
+    {
+      std::map<int, Request>::iterator request_it = request_table_.find(*waiting_it);
+
+      // canceled or timed out while waiting
+      if (request_it == request_table_.end())
+      {
+        waiting_it = waiting_request_list_.erase(waiting_it);
+        continue;
+      }
+
+      // keep the order of the requests with the same name
+      if (running_name_set_.find(request_it->second.name) != running_name_set_.end())
+      {
+        ++waiting_it;
+        continue;
+      }
+
+      request_id = request_it->first;
+      name = request_it->second.name;
+      call = request_it->second.call;
+      running_name_set_.insert(name);
+      waiting_request_list_.erase(waiting_it);
+      return true;
+    }
+
+    request_cond_.wait(lock);
+  }
+
+  return false;
+}
+
+}  // namespace thormang3_demo
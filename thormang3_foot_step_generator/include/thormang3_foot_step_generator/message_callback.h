@@ -32,6 +32,7 @@
 
 #include "thormang3_foot_step_generator/FootStepCommand.h"
 #include "thormang3_foot_step_generator/Step2DArray.h"
+#include "thormang3_foot_step_generator/CommandLatency.h"
 
 #include "robotis_controller_msgs/StatusMsg.h"
 #include "thormang3_walking_module_msgs/RobotPose.h"
@@ -51,8 +52,11 @@ void walkingModuleStatusMSGCallback(const robotis_controller_msgs::StatusMsg::Co
 
 void walkingCommandCallback(const thormang3_foot_step_generator::FootStepCommand::ConstPtr& msg);
 void step2DArrayCallback(const thormang3_foot_step_generator::Step2DArray::ConstPtr& msg);
+void step2DArrayAppendCallback(const thormang3_foot_step_generator::Step2DArray::ConstPtr& msg);
 
 bool isRunning(void);
 
+void publishCommandLatency(thormang3_foot_step_generator::CommandLatency& latency, int result);
+
 
 #endif /* THOMAMG3_FOOT_STEP_GENERATOR_MESSAGE_CALLBACK_H_ */
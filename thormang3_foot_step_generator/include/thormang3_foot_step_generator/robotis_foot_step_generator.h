@@ -28,6 +28,7 @@
 #include <eigen3/Eigen/Eigen>
 #include "thormang3_walking_module_msgs/AddStepDataArray.h"
 #include "thormang3_foot_step_generator/Step2DArray.h"
+#include "thormang3_foot_step_generator/rotation_math.h"
 
 #define STOP_WALKING           (0)
 #define FORWARD_WALKING        (1)
@@ -39,6 +40,9 @@
 
 #define MINIMUM_STEP_TIME_SEC  (0.4)
 
+#define SAME_STEP_POSITION_M   (0.001)
+#define SAME_STEP_ANGLE_RAD    (0.001)
+
 namespace thormang3
 {
 
@@ -59,9 +63,13 @@ public:
       const thormang3_walking_module_msgs::StepData& ref_step_data,
       int desired_step_type);
 
+  // continue_walking : the steps follow the reference step of the walking robot without the starting step,
+  //                    the requested steps up to the reference step are already reserved and skipped.
+  //                    the walking is started again after a reserved ending step
   void getStepDataFromStepData2DArray(thormang3_walking_module_msgs::AddStepDataArray::Request::_step_data_array_type* step_data_array,
       const thormang3_walking_module_msgs::StepData& ref_step_data,
-      const thormang3_foot_step_generator::Step2DArray::ConstPtr& request_step_2d);
+      const thormang3_foot_step_generator::Step2DArray::ConstPtr& request_step_2d,
+      bool continue_walking = false);
 
   int    num_of_step_;
   double fb_step_length_m_;
@@ -85,10 +93,10 @@ private:
   void calcRoStep(const thormang3_walking_module_msgs::StepData& ref_step_data, int direction);
   void calcStopStep(const thormang3_walking_module_msgs::StepData& ref_step_data, int direction);
 
-  Eigen::MatrixXd getTransformationXYZRPY(double position_x, double position_y, double position_z, double roll, double pitch, double yaw);
-  void getPosefromTransformMatrix(const Eigen::MatrixXd &matTransform, double *position_x, double *position_y, double *position_z, double *roll, double *pitch, double *yaw);
-  thormang3_walking_module_msgs::PoseXYZRPY getPosefromTransformMatrix(const Eigen::MatrixXd &matTransform);
-  Eigen::MatrixXd getInverseTransformation(Eigen::MatrixXd transform);
+  Eigen::Matrix4d getTransformationXYZRPY(double position_x, double position_y, double position_z, double roll, double pitch, double yaw);
+  void getPosefromTransformMatrix(const Eigen::Matrix4d &matTransform, double *position_x, double *position_y, double *position_z, double *roll, double *pitch, double *yaw);
+  thormang3_walking_module_msgs::PoseXYZRPY getPosefromTransformMatrix(const Eigen::Matrix4d &matTransform);
+  Eigen::Matrix4d getInverseTransformation(const Eigen::Matrix4d &transform);
 
   thormang3_walking_module_msgs::AddStepDataArray::Request::_step_data_array_type step_data_array_;
 
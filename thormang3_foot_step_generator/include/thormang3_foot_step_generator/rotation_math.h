@@ -0,0 +1,153 @@
+/*******************************************************************************
+* Copyright 2018 ROBOTIS CO., LTD.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*******************************************************************************/
+
+
+/*
+ * rotation_math.h
+ *
+ * Rotations and transformations in the fixed size types of Eigen.
+ * They are made on the stack, without the heap allocation of MatrixXd.
+ * Header only, used by the foot step generator and the demo.
+ */
+
+#ifndef THORMANG3_FOOT_STEP_GENERATOR_ROTATION_MATH_H_
+#define THORMANG3_FOOT_STEP_GENERATOR_ROTATION_MATH_H_
+
+#include <cmath>
+#include <eigen3/Eigen/Eigen>
+
+namespace thormang3
+{
+namespace rotation_math
+{
+
+inline Eigen::Matrix3d rotationX(double angle)
+{
+  double s = sin(angle), c = cos(angle);
+  Eigen::Matrix3d rotation;
+
+  rotation <<
+      1.0, 0.0, 0.0,
+      0.0,   c,  -s,
+      0.0,   s,   c;
+
+  return rotation;
+}
+
+inline Eigen::Matrix3d rotationY(double angle)
+{
+  double s = sin(angle), c = cos(angle);
+  Eigen::Matrix3d rotation;
+
+  rotation <<
+        c, 0.0,   s,
+      0.0, 1.0, 0.0,
+       -s, 0.0,   c;
+
+  return rotation;
+}
+
+inline Eigen::Matrix3d rotationZ(double angle)
+{
+  double s = sin(angle), c = cos(angle);
+  Eigen::Matrix3d rotation;
+
+  rotation <<
+        c,  -s, 0.0,
+        s,   c, 0.0,
+      0.0, 0.0, 1.0;
+
+  return rotation;
+}
+
+// Rz(yaw) * Ry(pitch) * Rx(roll), without the products of the three matrices
+inline Eigen::Matrix3d rpy2rotation(double roll, double pitch, double yaw)
+{
+  double sr = sin(roll), cr = cos(roll);
+  double sp = sin(pitch), cp = cos(pitch);
+  double sy = sin(yaw), cy = cos(yaw);
+  Eigen::Matrix3d rotation;
+
+  rotation <<
+      cy * cp, cy * sp * sr - sy * cr, cy * sp * cr + sy * sr,
+      sy * cp, sy * sp * sr + cy * cr, sy * sp * cr - cy * sr,
+          -sp,                cp * sr,                cp * cr;
+
+  return rotation;
+}
+
+inline Eigen::Vector3d rotation2rpy(const Eigen::Matrix3d &rotation)
+{
+  Eigen::Vector3d rpy;
+
+  rpy[0] = atan2(rotation.coeff(2, 1), rotation.coeff(2, 2));
+  rpy[1] = atan2(-rotation.coeff(2, 0),
+                 sqrt(rotation.coeff(2, 1) * rotation.coeff(2, 1) + rotation.coeff(2, 2) * rotation.coeff(2, 2)));
+  rpy[2] = atan2(rotation.coeff(1, 0), rotation.coeff(0, 0));
+
+  return rpy;
+}
+
+inline Eigen::Quaterniond rotation2quaternion(const Eigen::Matrix3d &rotation)
+{
+  return Eigen::Quaterniond(rotation);
+}
+
+inline Eigen::Matrix3d quaternion2rotation(const Eigen::Quaterniond &quaternion)
+{
+  return quaternion.toRotationMatrix();
+}
+
+inline Eigen::Quaterniond rpy2quaternion(double roll, double pitch, double yaw)
+{
+  return rotation2quaternion(rpy2rotation(roll, pitch, yaw));
+}
+
+inline Eigen::Vector3d quaternion2rpy(const Eigen::Quaterniond &quaternion)
+{
+  return rotation2rpy(quaternion.toRotationMatrix());
+}
+
+// homogeneous transformation of the position and Rz(yaw) * Ry(pitch) * Rx(roll)
+inline Eigen::Matrix4d transformationXYZRPY(double position_x, double position_y, double position_z,
+                                            double roll, double pitch, double yaw)
+{
+  Eigen::Matrix4d transformation = Eigen::Matrix4d::Identity();
+
+  transformation.block<3, 3>(0, 0) = rpy2rotation(roll, pitch, yaw);
+  transformation.coeffRef(0, 3) = position_x;
+  transformation.coeffRef(1, 3) = position_y;
+  transformation.coeffRef(2, 3) = position_z;
+
+  return transformation;
+}
+
+// inverse of a homogeneous transformation : [R^T, -R^T * p]
+inline Eigen::Matrix4d inverseTransformation(const Eigen::Matrix4d &transformation)
+{
+  Eigen::Matrix4d inverse = Eigen::Matrix4d::Identity();
+  Eigen::Matrix3d rotation_transpose = transformation.block<3, 3>(0, 0).transpose();
+
+  inverse.block<3, 3>(0, 0) = rotation_transpose;
+  inverse.block<3, 1>(0, 3) = -rotation_transpose * transformation.block<3, 1>(0, 3);
+
+  return inverse;
+}
+
+}  // namespace rotation_math
+}  // namespace thormang3
+
+#endif /* THORMANG3_FOOT_STEP_GENERATOR_ROTATION_MATH_H_ */
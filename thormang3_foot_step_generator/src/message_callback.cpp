@@ -49,6 +49,9 @@ ros::Subscriber     g_walking_module_status_msg_sub;
 ros::Subscriber     g_walking_command_sub;
 ros::Subscriber     g_balance_command_sub;
 ros::Subscriber     g_footsteps_2d_sub;
+ros::Subscriber     g_footsteps_2d_append_sub;
+
+ros::Publisher      g_command_latency_pub;
 
 thormang3::FootStepGenerator g_foot_stp_generator;
 
@@ -73,6 +76,9 @@ void initialize(void)
 
   g_walking_command_sub           = nh.subscribe("/robotis/thormang3_foot_step_generator/walking_command", 0, walkingCommandCallback);
   g_footsteps_2d_sub              = nh.subscribe("/robotis/thormang3_foot_step_generator/footsteps_2d",    0, step2DArrayCallback);
+  g_footsteps_2d_append_sub       = nh.subscribe("/robotis/thormang3_foot_step_generator/footsteps_2d_append", 0, step2DArrayAppendCallback);
+
+  g_command_latency_pub           = nh.advertise<thormang3_foot_step_generator::CommandLatency>("/robotis/thormang3_foot_step_generator/command_latency", 10);
 
   g_last_command_time = ros::Time::now().toSec();
 }
@@ -93,7 +99,13 @@ void walkingModuleStatusMSGCallback(const robotis_controller_msgs::StatusMsg::Co
 
 void walkingCommandCallback(const thormang3_foot_step_generator::FootStepCommand::ConstPtr &msg)
 {
-  double now_time = ros::Time::now().toSec();
+  thormang3_foot_step_generator::CommandLatency latency;
+  latency.command_id = msg->command_id;
+  latency.command    = msg->command;
+  latency.published  = msg->stamp;
+  latency.received   = ros::Time::now();
+
+  double now_time = latency.received.toSec();
 
   if((last_command.command == msg->command)
       && (last_command.step_num == msg->step_num)
@@ -195,6 +207,7 @@ void walkingCommandCallback(const thormang3_foot_step_generator::FootStepCommand
   }
 
   ref_step_data = get_ref_stp_data_srv.response.reference_step_data;
+  latency.ref_step_fetched = ros::Time::now();
 
   //calc step data
   if(msg->command == "forward")
@@ -287,7 +300,13 @@ void walkingCommandCallback(const thormang3_foot_step_generator::FootStepCommand
   add_stp_data_srv.request.remove_existing_step_data = true;
 
   //add step data
-  if(g_add_step_data_array_client.call(add_stp_data_srv) == true)
+  latency.steps_generated = ros::Time::now();
+  bool is_add_step_data_called = g_add_step_data_array_client.call(add_stp_data_srv);
+  latency.module_accepted = ros::Time::now();
+  publishCommandLatency(latency, is_add_step_data_called == true ? add_stp_data_srv.response.result
+                                                                 : thormang3_foot_step_generator::CommandLatency::CALL_FAILED);
+
+  if(is_add_step_data_called == true)
   {
     int add_stp_data_srv_result = add_stp_data_srv.response.result;
     if(add_stp_data_srv_result== thormang3_walking_module_msgs::AddStepDataArray::Response::NO_ERROR)
@@ -326,6 +345,12 @@ void walkingCommandCallback(const thormang3_foot_step_generator::FootStepCommand
 
 void step2DArrayCallback(const thormang3_foot_step_generator::Step2DArray::ConstPtr& msg)
 {
+  thormang3_foot_step_generator::CommandLatency latency;
+  latency.command_id = msg->command_id;
+  latency.command    = "footsteps_2d";
+  latency.published  = msg->stamp;
+  latency.received   = ros::Time::now();
+
   thormang3_walking_module_msgs::GetReferenceStepData get_ref_stp_data_srv;
   thormang3_walking_module_msgs::StepData             ref_step_data;
   thormang3_walking_module_msgs::AddStepDataArray     add_stp_data_srv;
@@ -343,6 +368,7 @@ void step2DArrayCallback(const thormang3_foot_step_generator::Step2DArray::Const
   }
 
   ref_step_data = get_ref_stp_data_srv.response.reference_step_data;
+  latency.ref_step_fetched = ros::Time::now();
 
   g_foot_stp_generator.getStepDataFromStepData2DArray(&add_stp_data_srv.request.step_data_array, ref_step_data, msg);
   g_is_running_check_needed = true;
@@ -352,7 +378,13 @@ void step2DArrayCallback(const thormang3_foot_step_generator::Step2DArray::Const
   add_stp_data_srv.request.remove_existing_step_data = true;
 
   //add step data
-  if(g_add_step_data_array_client.call(add_stp_data_srv) == true)
+  latency.steps_generated = ros::Time::now();
+  bool is_add_step_data_called = g_add_step_data_array_client.call(add_stp_data_srv);
+  latency.module_accepted = ros::Time::now();
+  publishCommandLatency(latency, is_add_step_data_called == true ? add_stp_data_srv.response.result
+                                                                 : thormang3_foot_step_generator::CommandLatency::CALL_FAILED);
+
+  if(is_add_step_data_called == true)
   {
     int add_stp_data_srv_result = add_stp_data_srv.response.result;
     if(add_stp_data_srv_result== thormang3_walking_module_msgs::AddStepDataArray::Response::NO_ERROR)
@@ -379,6 +411,93 @@ void step2DArrayCallback(const thormang3_foot_step_generator::Step2DArray::Const
   }
 }
 
+//the footsteps replace the steps after the reference step of the walking robot,
+//the positions are in the same frame as the footsteps which started the walking.
+//the request has the steps which are not walked yet, the reserved ones are skipped
+void step2DArrayAppendCallback(const thormang3_foot_step_generator::Step2DArray::ConstPtr& msg)
+{
+  thormang3_foot_step_generator::CommandLatency latency;
+  latency.command_id = msg->command_id;
+  latency.command    = "footsteps_2d_append";
+  latency.published  = msg->stamp;
+  latency.received   = ros::Time::now();
+
+  thormang3_walking_module_msgs::GetReferenceStepData get_ref_stp_data_srv;
+  thormang3_walking_module_msgs::StepData             ref_step_data;
+  thormang3_walking_module_msgs::AddStepDataArray     add_stp_data_srv;
+  thormang3_walking_module_msgs::IsRunning            is_running_srv;
+
+  //a stopped robot may have a different frame for the positions
+  if(g_is_running_client.call(is_running_srv) == false)
+  {
+    ROS_ERROR("[Demo]  : Failed to Walking Status");
+    return;
+  }
+  if(is_running_srv.response.is_running == false)
+  {
+    ROS_ERROR("[Demo]  : The robot is not walking, the footsteps are not appended");
+    return;
+  }
+
+  //get reference step data, the last step to be added after
+  if(g_get_ref_step_data_client.call(get_ref_stp_data_srv) == false)
+  {
+    ROS_ERROR("[Demo]  : Failed to get reference step data");
+    return;
+  }
+
+  ref_step_data = get_ref_stp_data_srv.response.reference_step_data;
+  latency.ref_step_fetched = ros::Time::now();
+
+  g_foot_stp_generator.getStepDataFromStepData2DArray(&add_stp_data_srv.request.step_data_array, ref_step_data, msg, true);
+  if(add_stp_data_srv.request.step_data_array.size() == 0)
+  {
+    ROS_ERROR("[Demo]  : Failed to make step data array to append");
+    return;
+  }
+  g_is_running_check_needed = true;
+
+  //the steps after the reference step are replaced as a walking command does,
+  //the walking module refuses the steps added to the existing ones while walking
+  add_stp_data_srv.request.auto_start = true;
+  add_stp_data_srv.request.remove_existing_step_data = true;
+
+  //add step data
+  latency.steps_generated = ros::Time::now();
+  bool is_add_step_data_called = g_add_step_data_array_client.call(add_stp_data_srv);
+  latency.module_accepted = ros::Time::now();
+  publishCommandLatency(latency, is_add_step_data_called == true ? add_stp_data_srv.response.result
+                                                                 : thormang3_foot_step_generator::CommandLatency::CALL_FAILED);
+
+  if(is_add_step_data_called == true)
+  {
+    int add_stp_data_srv_result = add_stp_data_srv.response.result;
+    if(add_stp_data_srv_result== thormang3_walking_module_msgs::AddStepDataArray::Response::NO_ERROR)
+      ROS_INFO("[Demo]  : Succeed to append step data array");
+    else {
+      ROS_ERROR("[Demo]  : Failed to append step data array");
+
+      if(add_stp_data_srv_result & thormang3_walking_module_msgs::AddStepDataArray::Response::NOT_ENABLED_WALKING_MODULE)
+        ROS_ERROR("[Demo]  : STEP_DATA_ERR::NOT_ENABLED_WALKING_MODULE");
+      if(add_stp_data_srv_result & thormang3_walking_module_msgs::AddStepDataArray::Response::PROBLEM_IN_POSITION_DATA)
+        ROS_ERROR("[Demo]  : STEP_DATA_ERR::PROBLEM_IN_POSITION_DATA");
+      if(add_stp_data_srv_result & thormang3_walking_module_msgs::AddStepDataArray::Response::PROBLEM_IN_TIME_DATA)
+        ROS_ERROR("[Demo]  : STEP_DATA_ERR::PROBLEM_IN_TIME_DATA");
+      if(add_stp_data_srv_result & thormang3_walking_module_msgs::AddStepDataArray::Response::TOO_MANY_STEP_DATA)
+        ROS_ERROR("[Demo]  : STEP_DATA_ERR::TOO_MANY_STEP_DATA");
+      if(add_stp_data_srv_result & thormang3_walking_module_msgs::AddStepDataArray::Response::ROBOT_IS_WALKING_NOW)
+        ROS_ERROR("[Demo]  : STEP_DATA_ERR::ROBOT_IS_WALKING_NOW");
+
+      return;
+    }
+  }
+  else
+  {
+    ROS_ERROR("[Demo]  : Failed to append step data array ");
+    return;
+  }
+}
+
 bool isRunning(void)
 {
   thormang3_walking_module_msgs::IsRunning is_running_srv;
@@ -398,4 +517,18 @@ bool isRunning(void)
   return false;
 }
 
-
+//reported after add_step_data is called, a command rejected before it is not reported
+void publishCommandLatency(thormang3_foot_step_generator::CommandLatency& latency, int result)
+{
+  latency.result = result;
+  g_command_latency_pub.publish(latency);
+
+  std::stringstream ss;
+  ss << "[Demo]  : Command Latency #" << latency.command_id << " " << latency.command << " [ms]";
+  if(latency.published.isZero() == false)
+    ss << " - sent : " << (latency.received - latency.published).toSec() * 1000.0;
+  ss << " - ref step : " << (latency.ref_step_fetched - latency.received).toSec() * 1000.0;
+  ss << " - steps : " << (latency.steps_generated - latency.ref_step_fetched).toSec() * 1000.0;
+  ss << " - accepted : " << (latency.module_accepted - latency.steps_generated).toSec() * 1000.0;
+  ROS_INFO_STREAM(ss.str());
+}
@@ -84,45 +84,12 @@ void FootStepGenerator::initialize()
   step_data_array_.clear();
 }
 
-Eigen::MatrixXd FootStepGenerator::getTransformationXYZRPY(double position_x, double position_y, double position_z, double roll, double pitch, double yaw)
+Eigen::Matrix4d FootStepGenerator::getTransformationXYZRPY(double position_x, double position_y, double position_z, double roll, double pitch, double yaw)
 {
-  double sr = sin(roll), cr = cos(roll);
-  double sp = sin(pitch), cp = cos(pitch);
-  double sy = sin(yaw), cy = cos(yaw);
-
-  Eigen::MatrixXd mat_roll(4,4);
-  Eigen::MatrixXd mat_pitch(4,4);
-  Eigen::MatrixXd mat_yaw(4,4);
-
-  mat_roll <<
-      1, 0, 0, 0,
-      0, cr, -sr, 0,
-      0, sr, cr, 0,
-      0, 0, 0, 1;
-
-  mat_pitch <<
-      cp, 0, sp, 0,
-      0, 1, 0, 0,
-      -sp, 0, cp, 0,
-      0, 0, 0, 1;
-
-  mat_yaw <<
-      cy, -sy, 0, 0,
-      sy, cy, 0, 0,
-      0, 0, 1, 0,
-      0, 0, 0, 1;
-
-  Eigen::MatrixXd mat_xyzrpy = (mat_yaw*mat_pitch)*mat_roll;
-
-  mat_xyzrpy.coeffRef(0, 3) = position_x;
-  mat_xyzrpy.coeffRef(1, 3) = position_y;
-  mat_xyzrpy.coeffRef(2, 3) = position_z;
-
-
-  return mat_xyzrpy;
+  return rotation_math::transformationXYZRPY(position_x, position_y, position_z, roll, pitch, yaw);
 }
 
-void FootStepGenerator::getPosefromTransformMatrix(const Eigen::MatrixXd &matTransform, double *position_x, double *position_y, double *position_z, double *roll, double *pitch, double *yaw)
+void FootStepGenerator::getPosefromTransformMatrix(const Eigen::Matrix4d &matTransform, double *position_x, double *position_y, double *position_z, double *roll, double *pitch, double *yaw)
 {
   *position_x = matTransform.coeff(0, 3);
   *position_y = matTransform.coeff(1, 3);
@@ -132,7 +99,7 @@ void FootStepGenerator::getPosefromTransformMatrix(const Eigen::MatrixXd &matTra
   *yaw        = atan2( matTransform.coeff(1,0), matTransform.coeff(0,0));
 }
 
-thormang3_walking_module_msgs::PoseXYZRPY FootStepGenerator::getPosefromTransformMatrix(const Eigen::MatrixXd &matTransform)
+thormang3_walking_module_msgs::PoseXYZRPY FootStepGenerator::getPosefromTransformMatrix(const Eigen::Matrix4d &matTransform)
 {
   thormang3_walking_module_msgs::PoseXYZRPY pose;
 
@@ -155,29 +122,10 @@ thormang3_walking_module_msgs::PoseXYZRPY FootStepGenerator::getPosefromTransfor
   return pose;
 }
 
-Eigen::MatrixXd FootStepGenerator::getInverseTransformation(Eigen::MatrixXd transform)
+Eigen::Matrix4d FootStepGenerator::getInverseTransformation(const Eigen::Matrix4d &transform)
 {
   // If T is Transform Matrix A from B, the BOA is translation component coordi. B to coordi. A
-
-  Eigen::Vector3d vec_boa;
-  Eigen::Vector3d vec_x, vec_y, vec_z;
-  Eigen::MatrixXd inv_t(4,4);
-
-  vec_boa(0) = -transform(0,3);
-  vec_boa(1) = -transform(1,3);
-  vec_boa(2) = -transform(2,3);
-
-  vec_x(0) = transform(0,0); vec_x(1) = transform(1,0); vec_x(2) = transform(2,0);
-  vec_y(0) = transform(0,1); vec_y(1) = transform(1,1); vec_y(2) = transform(2,1);
-  vec_z(0) = transform(0,2); vec_z(1) = transform(1,2); vec_z(2) = transform(2,2);
-
-  inv_t <<
-      vec_x(0), vec_x(1), vec_x(2), vec_boa.dot(vec_x),
-      vec_y(0), vec_y(1), vec_y(2), vec_boa.dot(vec_y),
-      vec_z(0), vec_z(1), vec_z(2), vec_boa.dot(vec_z),
-      0, 0, 0, 1;
-
-  return inv_t;
+  return rotation_math::inverseTransformation(transform);
 }
 
 void FootStepGenerator::getStepData(thormang3_walking_module_msgs::AddStepDataArray::Request::_step_data_array_type* step_data_array, const thormang3_walking_module_msgs::StepData& ref_step_data, int desired_step_type)
@@ -203,36 +151,88 @@ void FootStepGenerator::getStepData(thormang3_walking_module_msgs::AddStepDataAr
 
 void FootStepGenerator::getStepDataFromStepData2DArray(thormang3_walking_module_msgs::AddStepDataArray::Request::_step_data_array_type* step_data_array,
     const thormang3_walking_module_msgs::StepData& ref_step_data,
-    const thormang3_foot_step_generator::Step2DArray::ConstPtr& request_step_2d)
+    const thormang3_foot_step_generator::Step2DArray::ConstPtr& request_step_2d,
+    bool continue_walking)
 {
   step_data_array->clear();
 
   thormang3_walking_module_msgs::StepData stp_data;
 
   stp_data = ref_step_data;
-  stp_data.time_data.abs_step_time += start_end_time_sec_;
-  stp_data.time_data.dsp_ratio = dsp_ratio_;
-  stp_data.time_data.walking_state = thormang3_walking_module_msgs::StepTimeData::IN_WALKING_STARTING;
-  stp_data.time_data.start_time_delay_ratio_x     = 0.0;
-  stp_data.time_data.start_time_delay_ratio_y     = 0.0;
-  stp_data.time_data.start_time_delay_ratio_z     = 0.0;
-  stp_data.time_data.start_time_delay_ratio_roll  = 0.0;
-  stp_data.time_data.start_time_delay_ratio_pitch = 0.0;
-  stp_data.time_data.start_time_delay_ratio_yaw   = 0.0;
-  stp_data.time_data.finish_time_advance_ratio_x     = 0.0;
-  stp_data.time_data.finish_time_advance_ratio_y     = 0.0;
-  stp_data.time_data.finish_time_advance_ratio_z     = 0.0;
-  stp_data.time_data.finish_time_advance_ratio_roll  = 0.0;
-  stp_data.time_data.finish_time_advance_ratio_pitch = 0.0;
-  stp_data.time_data.finish_time_advance_ratio_yaw   = 0.0;
 
-  stp_data.position_data.moving_foot = thormang3_walking_module_msgs::StepPositionData::STANDING;
-  stp_data.position_data.foot_z_swap = 0;
-  stp_data.position_data.body_z_swap = 0;
+  //the ending step of the first steps can be reserved already, the walking is started again after it
+  bool is_ref_step_ending = (continue_walking == true)
+      && (ref_step_data.time_data.walking_state == thormang3_walking_module_msgs::StepTimeData::IN_WALKING_ENDING);
 
-  step_data_array->push_back(stp_data);
+  //the robot is already walking, the steps follow the reference step
+  if((continue_walking == false) || (is_ref_step_ending == true))
+  {
+    stp_data.time_data.abs_step_time += start_end_time_sec_;
+    stp_data.time_data.dsp_ratio = dsp_ratio_;
+    stp_data.time_data.walking_state = thormang3_walking_module_msgs::StepTimeData::IN_WALKING_STARTING;
+    stp_data.time_data.start_time_delay_ratio_x     = 0.0;
+    stp_data.time_data.start_time_delay_ratio_y     = 0.0;
+    stp_data.time_data.start_time_delay_ratio_z     = 0.0;
+    stp_data.time_data.start_time_delay_ratio_roll  = 0.0;
+    stp_data.time_data.start_time_delay_ratio_pitch = 0.0;
+    stp_data.time_data.start_time_delay_ratio_yaw   = 0.0;
+    stp_data.time_data.finish_time_advance_ratio_x     = 0.0;
+    stp_data.time_data.finish_time_advance_ratio_y     = 0.0;
+    stp_data.time_data.finish_time_advance_ratio_z     = 0.0;
+    stp_data.time_data.finish_time_advance_ratio_roll  = 0.0;
+    stp_data.time_data.finish_time_advance_ratio_pitch = 0.0;
+    stp_data.time_data.finish_time_advance_ratio_yaw   = 0.0;
+
+    stp_data.position_data.moving_foot = thormang3_walking_module_msgs::StepPositionData::STANDING;
+    stp_data.position_data.foot_z_swap = 0;
+    stp_data.position_data.body_z_swap = 0;
+
+    step_data_array->push_back(stp_data);
+  }
+
+  //the starting step of the walking robot is the reference before any requested step is reserved
+  unsigned int start_stp_idx = 0;
+  if((continue_walking == true)
+      && ((is_ref_step_ending == true)
+          || (ref_step_data.position_data.moving_foot != thormang3_walking_module_msgs::StepPositionData::STANDING)))
+  {
+    //the last requested step at the reference step, the steps after it are not reserved yet.
+    //the ending step has both feet of the last reserved steps
+    bool found_ref_step = false;
+    for(unsigned int stp_idx = 0; stp_idx < request_step_2d->footsteps_2d.size(); stp_idx++)
+    {
+      const thormang3_foot_step_generator::Step2D& step_2d = request_step_2d->footsteps_2d[stp_idx];
+      const thormang3_walking_module_msgs::PoseXYZRPY* ref_foot_pose;
+
+      if(((is_ref_step_ending == true)
+          || (ref_step_data.position_data.moving_foot == thormang3_walking_module_msgs::StepPositionData::LEFT_FOOT_SWING))
+          && (step_2d.moving_foot == thormang3_foot_step_generator::Step2D::LEFT_FOOT_SWING))
+        ref_foot_pose = &ref_step_data.position_data.left_foot_pose;
+      else if(((is_ref_step_ending == true)
+          || (ref_step_data.position_data.moving_foot == thormang3_walking_module_msgs::StepPositionData::RIGHT_FOOT_SWING))
+          && (step_2d.moving_foot == thormang3_foot_step_generator::Step2D::RIGHT_FOOT_SWING))
+        ref_foot_pose = &ref_step_data.position_data.right_foot_pose;
+      else
+        continue;
+
+      if((fabs(step_2d.step2d.x - ref_foot_pose->x) < SAME_STEP_POSITION_M)
+          && (fabs(step_2d.step2d.y - ref_foot_pose->y) < SAME_STEP_POSITION_M)
+          && (fabs(remainder(step_2d.step2d.theta - ref_foot_pose->yaw, 2*M_PI)) < SAME_STEP_ANGLE_RAD))
+      {
+        start_stp_idx = stp_idx + 1;
+        found_ref_step = true;
+      }
+    }
+
+    if(found_ref_step == false)
+    {
+      ROS_ERROR("The reference step is not in the requested steps");
+      step_data_array->clear();
+      return;
+    }
+  }
 
-  for(unsigned int stp_idx = 0; stp_idx < request_step_2d->footsteps_2d.size(); stp_idx++)
+  for(unsigned int stp_idx = start_stp_idx; stp_idx < request_step_2d->footsteps_2d.size(); stp_idx++)
   {
     stp_data.time_data.abs_step_time += step_time_sec_;
     stp_data.time_data.walking_state = thormang3_walking_module_msgs::StepTimeData::IN_WALKING;
@@ -312,16 +312,16 @@ bool FootStepGenerator::calcStep(const thormang3_walking_module_msgs::StepData&
   poseGtoRF = ref_step_data.position_data.right_foot_pose;
   poseGtoLF = ref_step_data.position_data.left_foot_pose;
 
-  Eigen::MatrixXd mat_g_to_rf = getTransformationXYZRPY(poseGtoRF.x, poseGtoRF.y, poseGtoRF.z, 0, 0, poseGtoRF.yaw);
-  Eigen::MatrixXd mat_g_to_lf = getTransformationXYZRPY(poseGtoLF.x, poseGtoLF.y, poseGtoLF.z, 0, 0, poseGtoLF.yaw);
+  Eigen::Matrix4d mat_g_to_rf = getTransformationXYZRPY(poseGtoRF.x, poseGtoRF.y, poseGtoRF.z, 0, 0, poseGtoRF.yaw);
+  Eigen::Matrix4d mat_g_to_lf = getTransformationXYZRPY(poseGtoLF.x, poseGtoLF.y, poseGtoLF.z, 0, 0, poseGtoLF.yaw);
 
   //the local coordinate is set as below.
   //the below local does not means real local coordinate.
   //it is just for calculating step data.
   //the local coordinate will be decide by the moving foot of ref step data
-  Eigen::MatrixXd mat_lf_to_local = getTransformationXYZRPY(0, -0.5*default_y_feet_offset_m_, 0, 0, 0, 0);
-  Eigen::MatrixXd mat_rf_to_local = getTransformationXYZRPY(0,  0.5*default_y_feet_offset_m_, 0, 0, 0, 0);
-  Eigen::MatrixXd mat_global_to_local, mat_local_to_global;
+  Eigen::Matrix4d mat_lf_to_local = getTransformationXYZRPY(0, -0.5*default_y_feet_offset_m_, 0, 0, 0, 0);
+  Eigen::Matrix4d mat_rf_to_local = getTransformationXYZRPY(0,  0.5*default_y_feet_offset_m_, 0, 0, 0, 0);
+  Eigen::Matrix4d mat_global_to_local, mat_local_to_global;
   if(ref_step_data.position_data.moving_foot == thormang3_walking_module_msgs::StepPositionData::RIGHT_FOOT_SWING)
   {
     mat_global_to_local = mat_g_to_rf*mat_rf_to_local;
@@ -335,8 +335,8 @@ bool FootStepGenerator::calcStep(const thormang3_walking_module_msgs::StepData&
     mat_rf_to_local     = getInverseTransformation(mat_g_to_rf) * mat_global_to_local;
   }
 
-  Eigen::MatrixXd mat_local_to_rf = mat_local_to_global * mat_g_to_rf;
-  Eigen::MatrixXd mat_local_to_lf = mat_local_to_global * mat_g_to_lf;
+  Eigen::Matrix4d mat_local_to_rf = mat_local_to_global * mat_g_to_rf;
+  Eigen::Matrix4d mat_local_to_lf = mat_local_to_global * mat_g_to_lf;
 
   poseLtoRF = getPosefromTransformMatrix(mat_local_to_rf);
   poseLtoLF = getPosefromTransformMatrix(mat_local_to_lf);
@@ -578,14 +578,14 @@ bool FootStepGenerator::calcStep(const thormang3_walking_module_msgs::StepData&
 
   for(unsigned int stp_idx = 0; stp_idx < step_data_array_.size(); stp_idx++)
   {
-    Eigen::MatrixXd mat_r_foot = getTransformationXYZRPY(step_data_array_[stp_idx].position_data.right_foot_pose.x,
+    Eigen::Matrix4d mat_r_foot = getTransformationXYZRPY(step_data_array_[stp_idx].position_data.right_foot_pose.x,
         step_data_array_[stp_idx].position_data.right_foot_pose.y,
         step_data_array_[stp_idx].position_data.right_foot_pose.z,
         step_data_array_[stp_idx].position_data.right_foot_pose.roll,
         step_data_array_[stp_idx].position_data.right_foot_pose.pitch,
         step_data_array_[stp_idx].position_data.right_foot_pose.yaw);
 
-    Eigen::MatrixXd mat_l_foot = getTransformationXYZRPY(step_data_array_[stp_idx].position_data.left_foot_pose.x,
+    Eigen::Matrix4d mat_l_foot = getTransformationXYZRPY(step_data_array_[stp_idx].position_data.left_foot_pose.x,
         step_data_array_[stp_idx].position_data.left_foot_pose.y,
         step_data_array_[stp_idx].position_data.left_foot_pose.z,
         step_data_array_[stp_idx].position_data.left_foot_pose.roll,
@@ -83,14 +83,13 @@ bool QNode::init()
 
 void QNode::run()
 {
+  // this node has no subscriber, the thread sleeps until shutdown
+  ros::AsyncSpinner spinner(1);
+  spinner.start();
 
-  ros::Rate loop_rate(125);
+  ros::waitForShutdown();
 
-  while (ros::ok())
-  {
-    ros::spinOnce();
-    loop_rate.sleep();
-  }
+  spinner.stop();
   std::cout << "Ros shutdown, proceeding to close the gui." << std::endl;
   Q_EMIT rosShutdown();  // used to signal the gui for a shutdown (useful to roslaunch)
 }
@@ -30,6 +30,7 @@
 
 #include <ros/ros.h>
 #include <ros/package.h>
+#include <ros/callback_queue.h>
 #include <string>
 #include <QThread>
 #include <QStringListModel>
@@ -137,6 +138,7 @@ Q_SIGNALS:
   ros::Subscriber imu_sub_;
   ros::Subscriber ft_right_sub_;
   ros::Subscriber ft_left_sub_;
+  ros::CallbackQueue sensor_callback_queue_;  // imu and ft
 
   ros::Subscriber present_joint_offset_data_sub_;
 
@@ -70,9 +70,11 @@ MainWindow::MainWindow(int argc, char** argv, QWidget *parent)
 
   qRegisterMetaType<thormang3_tuning_module_msgs::JointOffsetPositionData>("thormang3_tuning_module_msgs::JointOffsetPositionData");
   QObject::connect(&qnode_, SIGNAL(updatePresentJointOffsetData(thormang3_tuning_module_msgs::JointOffsetPositionData)), this,
-                   SLOT(updateJointOffsetSpinbox(thormang3_tuning_module_msgs::JointOffsetPositionData)));
-  QObject::connect(&qnode_, SIGNAL(updateFT(bool, double)), this, SLOT(updateFT(bool, double)));
-  QObject::connect(&qnode_, SIGNAL(updateIMU(double, double)), this, SLOT(updateIMU(double, double)));
+                   SLOT(updateJointOffsetSpinbox(thormang3_tuning_module_msgs::JointOffsetPositionData)),
+                   Qt::QueuedConnection);
+  QObject::connect(&qnode_, SIGNAL(updateFT(bool, double)), this, SLOT(updateFT(bool, double)), Qt::QueuedConnection);
+  QObject::connect(&qnode_, SIGNAL(updateIMU(double, double)), this, SLOT(updateIMU(double, double)),
+                   Qt::QueuedConnection);
 
   /*********************
    ** Logging
@@ -65,6 +65,10 @@ bool QNode::init()
   ros::start();  // explicitly needed since our nodehandle is going out of scope.
   ros::NodeHandle ros_node;
 
+  // high rate sensor topics are spun by their own thread, see run()
+  ros::NodeHandle sensor_node;
+  sensor_node.setCallbackQueue(&sensor_callback_queue_);
+
   // Add your ros communications here
   joint_offset_data_pub_ = ros_node.advertise<thormang3_tuning_module_msgs::JointOffsetData>(
       "/robotis/tuning_module/joint_offset_data", 0);
@@ -75,9 +79,9 @@ bool QNode::init()
   command_pub_ = ros_node.advertise<std_msgs::String>("/robotis/tuning_module/command", 0);
   tuning_pose_pub_ = ros_node.advertise<std_msgs::String>("/robotis/tuning_module/tuning_pose", 0);
   present_joint_offset_data_sub_ = ros_node.subscribe("/robotis/tuning_module/present_joints_data", 1, &QNode::presentJointOffsetDataCallback, this);
-  imu_sub_ = ros_node.subscribe("/robotis/sensor/imu/imu", 1, &QNode::imuCallback, this);
-  ft_right_sub_ = ros_node.subscribe("/robotis/sensor/ft_right_foot/scaled", 1, &QNode::ftRightCallback, this);
-  ft_left_sub_ = ros_node.subscribe("/robotis/sensor/ft_left_foot/scaled", 1, &QNode::ftLeftCallback, this);
+  imu_sub_ = sensor_node.subscribe("/robotis/sensor/imu/imu", 1, &QNode::imuCallback, this);
+  ft_right_sub_ = sensor_node.subscribe("/robotis/sensor/ft_right_foot/scaled", 1, &QNode::ftRightCallback, this);
+  ft_left_sub_ = sensor_node.subscribe("/robotis/sensor/ft_left_foot/scaled", 1, &QNode::ftLeftCallback, this);
 
   get_present_joint_offset_data_client_ = ros_node.serviceClient<thormang3_tuning_module_msgs::GetPresentJointOffsetData>(
       "/robotis/tuning_module/get_present_joint_offset_data");
@@ -91,14 +95,18 @@ bool QNode::init()
 
 void QNode::run()
 {
+  // callbacks are called as soon as messages arrive and this thread sleeps until shutdown.
+  // they update the gui only through signals, which are queued to the gui thread
+  ros::AsyncSpinner sensor_spinner(1, &sensor_callback_queue_);
+  ros::AsyncSpinner default_spinner(1);  // present joint data
 
-  ros::Rate loop_rate(125);
+  sensor_spinner.start();
+  default_spinner.start();
 
-  while (ros::ok())
-  {
-    ros::spinOnce();
-    loop_rate.sleep();
-  }
+  ros::waitForShutdown();
+
+  sensor_spinner.stop();
+  default_spinner.stop();
 
   std::cout << "Ros shutdown, proceeding to close the gui." << std::endl;
   Q_EMIT rosShutdown();  // used to signal the gui for a shutdown (useful to roslaunch)